@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 class Player;
 class Enemy;
@@ -43,6 +44,8 @@ public:
 
 private:
     void processTurn();
+    // Battle events go to the on-screen battle log (and the console)
+    void message(const std::string& text);
     void displayBattleOptions();
     void displayBattleStatus();
 
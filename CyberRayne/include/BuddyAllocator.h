@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Buddy allocator over a power-of-two range of offsets (no memory of its own). Blocks are powers of
+// two and aligned to their own size, so any power-of-two alignment up to the block size comes for
+// free. Freed blocks merge with their buddy, and allocations take the lowest free offset so live
+// data gathers at the front of the range.
+class BuddyAllocator {
+public:
+    // size and minBlockSize are rounded up to powers of two
+    BuddyAllocator(uint64_t size, uint64_t minBlockSize);
+
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+    void free(uint64_t offset);
+
+    uint64_t getSize() const { return m_size; }
+    uint64_t getUsed() const { return m_used; }  // Including the rounding of each allocation
+    uint32_t getAllocationCount() const { return static_cast<uint32_t>(m_allocated.size()); }
+    uint64_t getLargestFreeBlock() const;
+    bool isEmpty() const { return m_allocated.empty(); }
+
+    static uint64_t roundUpToPowerOfTwo(uint64_t value);
+
+private:
+    uint64_t blockSize(uint32_t level) const { return m_size >> level; }
+
+    uint64_t m_size;
+    uint64_t m_minBlockSize;
+    uint32_t m_levelCount;                        // Level 0 is the whole range, the last is minBlockSize
+    std::vector<std::set<uint64_t>> m_freeBlocks; // Free block offsets per level
+    std::unordered_map<uint64_t, uint32_t> m_allocated; // Offset -> level
+    uint64_t m_used = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+// 2D camera over the world. World units are tiles: x to the right, y down, tile (x, y) covers
+// [x, x+1) x [y, y+1). The camera shows viewHeight / zoom units vertically and as many horizontally
+// as the viewport's aspect allows, so nothing assumes a particular window shape.
+//
+// The renderer puts getViewMatrix() and getProjectionMatrix() into the frame uniforms, and the
+// world layers (tiles and entities) are queued in world units: scrolling changes two matrices, not
+// every queued sprite.
+class Camera2D {
+public:
+    Camera2D() = default;
+
+    // Pixel size of the target the world is drawn into (only the aspect ratio and pixel snapping
+    // depend on it)
+    void setViewportSize(float width, float height);
+    // World units visible vertically at zoom 1
+    void setViewHeight(float units) { m_viewHeight = units > 0.0f ? units : m_viewHeight; }
+    // > 1 magnifies
+    void setZoom(float zoom) { m_zoom = zoom > 0.0f ? zoom : m_zoom; }
+    float getZoom() const { return m_zoom; }
+
+    // Moves there at once (and stops any smoothing towards the old target)
+    void setPosition(float x, float y);
+    // Target the camera eases towards in update(). smoothing is the time in seconds to cover about
+    // 63% of the remaining distance; 0 snaps.
+    void follow(float x, float y) { m_targetX = x; m_targetY = y; }
+    void setSmoothing(float seconds) { m_smoothing = seconds > 0.0f ? seconds : 0.0f; }
+    void snapToTarget() { m_x = m_targetX; m_y = m_targetY; }
+    void update(float deltaTime);
+
+    // World rect the view is kept inside (a map's extent); a view larger than the rect is centred on
+    // it. Cleared by an empty rect.
+    void setBounds(float minX, float minY, float maxX, float maxY);
+    void clearBounds() { m_hasBounds = false; }
+
+    // Centre of the view after bounds and pixel snapping: what the matrices use
+    void getCenter(float& x, float& y) const;
+    // minX, minY, maxX, maxY in world units
+    void getVisibleRect(float rect[4]) const;
+    float getVisibleWidth() const;
+    float getVisibleHeight() const { return m_viewHeight / m_zoom; }
+
+    // Column-major 4x4 matrices (GLSL mat4 layout): view translates the centre to the origin,
+    // projection scales the visible rect to NDC
+    void getViewMatrix(float out[16]) const;
+    void getProjectionMatrix(float out[16]) const;
+    static void identity(float out[16]);
+
+private:
+    float m_viewportWidth = 1920.0f;
+    float m_viewportHeight = 1080.0f;
+    float m_viewHeight = 15.0f;
+    float m_zoom = 1.0f;
+    float m_x = 0.0f, m_y = 0.0f;
+    float m_targetX = 0.0f, m_targetY = 0.0f;
+    float m_smoothing = 0.0f;
+    bool m_hasBounds = false;
+    float m_bounds[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+};
@@ -25,6 +25,7 @@ public:
     bool initialize();
 #ifndef NO_VULKAN
     void loadTextures(VulkanRenderer* renderer);  // Load character textures
+    void releaseTextures(VulkanRenderer* renderer);
 #endif
     void update(float deltaTime);
     void handleInput(int key);  // Handle keyboard input
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include "ImageData.h"
+
+// ".crtex" container written by the asset_cooker tool: RGBA8 pixels ready for upload, with the full
+// mip chain. Layout: CookedTextureHeader, mipCount CookedTextureLevel entries, then the level data
+// (each level starts on a COOKED_TEXTURE_ALIGNMENT boundary). All fields are little-endian.
+static const char COOKED_TEXTURE_MAGIC[4] = {'C', 'R', 'T', 'X'};
+static const uint32_t COOKED_TEXTURE_VERSION = 2;      // 2: premultiplied and mip-filtered in linear light
+static const uint32_t COOKED_TEXTURE_ALIGNMENT = 16;
+static const uint32_t COOKED_TEXTURE_MAX_EXTENT = 16384; // Largest level 0 edge open() accepts
+static const uint32_t COOKED_TEXTURE_PREMULTIPLIED = 1u << 0; // Colour channels are multiplied by alpha
+
+struct CookedTextureHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;     // Level 0 size
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t flags;
+};
+
+struct CookedTextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;    // From the start of the file
+    uint64_t size;      // width * height * 4
+};
+
+// Read-only memory mapping of a cooked texture. Level data is used straight from the mapping.
+class CookedTextureFile {
+public:
+    ~CookedTextureFile();
+
+    CookedTextureFile(const CookedTextureFile&) = delete;
+    CookedTextureFile& operator=(const CookedTextureFile&) = delete;
+
+    // Map and validate a container. Returns nullptr if the file is missing or malformed: every level
+    // must have the size, offset and extent write() would have given it, inside the file.
+    static std::shared_ptr<CookedTextureFile> open(const std::string& path);
+
+    // Open the cooked sibling of a source image (foo.png -> foo.crtex), nullptr if there is none
+    static std::shared_ptr<CookedTextureFile> openForSource(const std::string& sourcePath);
+    static std::string cookedPathFor(const std::string& sourcePath);
+
+    // Write a container from a mip chain (level 0 first)
+    static bool write(const std::string& path, const std::vector<ImageData>& levels, uint32_t flags);
+
+    const CookedTextureHeader& getHeader() const { return *reinterpret_cast<const CookedTextureHeader*>(m_data); }
+    uint32_t getMipCount() const { return getHeader().mipCount; }
+    const CookedTextureLevel& getLevel(uint32_t level) const;
+    const uint8_t* getLevelData(uint32_t level) const { return m_data + getLevel(level).offset; }
+    size_t getDataSize() const { return m_size; }
+
+    // First level whose edges fit within maxSize (0 = level 0)
+    uint32_t findLevelForSize(int maxSize) const;
+    ImageData levelToImage(uint32_t level) const;
+
+private:
+    CookedTextureFile() = default;
+    bool validate() const;
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "BuddyAllocator.h"
+
+// A piece of device memory handed out by DeviceAllocator
+struct DeviceAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;      // Bind offset into memory
+    VkDeviceSize size = 0;
+    void* mapped = nullptr;       // Host-visible memory stays mapped; already points at offset
+    int32_t pool = -1;
+    int32_t block = -1;           // -1 for dedicated allocations
+};
+
+// Sub-allocates buffers and images from large VkDeviceMemory blocks, one pool of blocks per memory
+// type, carving each block with a buddy allocator. Linear resources (buffers) and optimal-tiling
+// images go to separate pools when bufferImageGranularity is coarser than the smallest buddy block,
+// so they never share a granularity page. Sampled textures always get pools of their own: they are
+// the only resources the renderer can move, so only their blocks are worth evacuating when
+// defragmenting. Requests bigger than half a block get their own
+// VkDeviceMemory. Thread-safe: the game thread creates textures and sprite sets while the render
+// thread allocates frame data and transient targets.
+class DeviceAllocator {
+public:
+    enum class ResourceKind {
+        Linear,     // Buffers and linear-tiling images
+        Optimal,    // Optimal-tiling images that stay put (render targets)
+        Texture     // Sampled optimal-tiling images, movable by defragmentation
+    };
+
+    struct Stats {
+        uint32_t blockCount = 0;
+        uint32_t dedicatedCount = 0;
+        uint32_t allocationCount = 0;     // Sub-allocations plus dedicated ones
+        VkDeviceSize blockBytes = 0;      // Reserved in blocks
+        VkDeviceSize usedBytes = 0;       // Used inside blocks (buddy rounding included)
+        VkDeviceSize dedicatedBytes = 0;
+    };
+
+    void initialize(VkPhysicalDevice physicalDevice, VkDevice device);
+    // Frees every block; all allocations must be gone (or abandoned at shutdown)
+    void destroy();
+
+    // Throws std::runtime_error when no memory type fits or the device is out of memory
+    DeviceAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind);
+    void free(DeviceAllocation& allocation);
+
+    Stats getStats() const;
+    void logStats() const;
+
+    // Defragmentation: marks sparsely used Texture blocks so new allocations avoid them. Callers then move
+    // the resources that isEvacuating reports (allocate, copy, free the old one) and call
+    // endDefragmentation once the old copies are freed; emptied blocks are released as they empty.
+    // Returns false when nothing is worth moving.
+    bool beginDefragmentation();
+    bool isEvacuating(const DeviceAllocation& allocation) const;
+    void endDefragmentation();
+
+private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint8_t* mapped = nullptr;
+        std::unique_ptr<BuddyAllocator> buddy;
+        bool evacuating = false;
+    };
+    struct Pool {
+        uint32_t memoryTypeIndex = 0;
+        ResourceKind kind = ResourceKind::Linear;
+        VkDeviceSize blockSize = 0;
+        std::vector<Block> blocks;  // Freed blocks stay as empty slots so block indices remain valid
+    };
+
+    static const VkDeviceSize MIN_BUDDY_BLOCK = 256;
+    static const VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+    static constexpr float EVACUATE_BELOW_USAGE = 0.5f;  // Blocks used less than this are evacuated
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    int getPool(uint32_t memoryTypeIndex, ResourceKind kind);
+    VkDeviceMemory allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** mapped);
+    void releaseEmptyBlock(Pool& pool, size_t blockIndex);
+
+    VkDevice m_device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+    VkDeviceSize m_bufferImageGranularity = 1;
+    mutable std::mutex m_mutex;
+    std::vector<Pool> m_pools;
+    uint32_t m_dedicatedCount = 0;
+    VkDeviceSize m_dedicatedBytes = 0;
+};
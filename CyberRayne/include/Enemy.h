@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "SpriteAnimation.h"
 
 class Spell;
 
@@ -30,6 +31,9 @@ public:
     void setHealth(int health) { m_health = health; }
     void setMana(int mana) { m_mana = mana; }
     void setPosition(float x, float y) { m_x = x; m_y = y; }
+    // Sprite-sheet clip drawn instead of the plain sprite (taken up when the map's sprites are rebuilt)
+    void setAnimation(const AnimationPlayback& animation) { m_animation = animation; }
+    const AnimationPlayback& getAnimation() const { return m_animation; }
 
     // Combat functions
     void takeDamage(int damage);
@@ -66,6 +70,7 @@ protected:
     int m_goldReward;
     float m_x;
     float m_y;
+    AnimationPlayback m_animation;
 
     std::vector<std::shared_ptr<Spell>> m_spells;
 };
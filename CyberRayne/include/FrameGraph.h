@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Per-frame render graph over images. Passes are declared in execution order together with the
+// images they use and how; compile() then
+//  - culls passes whose results never reach an output (an import with a final usage, or a pass
+//    marked as having side effects),
+//  - derives the barrier each use needs: a layout change, a wait on earlier readers (write after
+//    read) or on the last writer with its writes flushed, and nothing for repeated reads,
+//  - packs transient images whose lifetimes don't overlap into one shared heap.
+// Nothing here is Vulkan specific: the renderer maps each Usage to a layout, stage and access mask,
+// and creates and binds the transient images at the offsets compile() picked.
+class FrameGraph {
+public:
+    // How a pass uses an image; each usage is one layout and one pipeline stage
+    enum class Usage : uint32_t {
+        None,             // Contents undefined: the first use of a transient, a freshly acquired image
+        ColorAttachment,
+        Sampled,
+        TransferSrc,
+        TransferDst,
+        Present,
+        Count
+    };
+    static uint32_t usageBit(Usage usage) { return 1u << static_cast<uint32_t>(usage); }
+    static bool isWriteUsage(Usage usage) { return usage == Usage::ColorAttachment || usage == Usage::TransferDst; }
+
+    struct Barrier {
+        int resource;
+        Usage before;         // Layout to leave; None discards the contents
+        Usage after;
+        uint32_t waitUsages;  // usageBit mask of the stages that must finish first
+        bool flushWrites;     // The waited-on work wrote the memory
+    };
+    struct ScheduledPass {
+        int pass;
+        std::vector<Barrier> barriers;  // Recorded before the pass
+    };
+
+    // Clears every declaration (capacity is kept, so per-frame rebuilds don't allocate)
+    void reset();
+
+    // An image owned elsewhere (swapchain image). It arrives in `initial` and is left in `final`;
+    // a final usage other than None makes it an output, which keeps its writers alive.
+    int importImage(const std::string& name, Usage initial, Usage final);
+    // An image that only lives within the frame; size and alignment are its memory requirements
+    int createTransient(const std::string& name, uint64_t size, uint64_t alignment);
+
+    int addPass(const std::string& name, std::function<void()> execute);
+    void read(int pass, int resource, Usage usage);
+    // Overwrites the whole image, so earlier contents are not needed
+    void write(int pass, int resource, Usage usage);
+    // Reads and writes (an attachment loaded rather than cleared)
+    void modify(int pass, int resource, Usage usage);
+    // Keeps the pass even when nothing reads what it writes (readbacks)
+    void setSideEffect(int pass);
+
+    void compile();
+    // Runs the scheduled passes, handing each one's barriers to emitBarriers first and the final
+    // transitions of imported images last
+    void execute(const std::function<void(const std::vector<Barrier>&)>& emitBarriers);
+
+    const std::vector<ScheduledPass>& getSchedule() const { return m_schedule; }
+    const std::vector<Barrier>& getFinalBarriers() const { return m_finalBarriers; }
+    size_t getPassCount() const { return m_passes.size(); }
+    const std::string& getPassName(int pass) const { return m_passes[pass].name; }
+    bool isCulled(int pass) const { return !m_passes[pass].live; }
+    const std::string& getResourceName(int resource) const { return m_resources[resource].name; }
+    bool isTransient(int resource) const { return m_resources[resource].transient; }
+    // UINT64_MAX for transients no live pass uses (they need no memory)
+    uint64_t getTransientOffset(int resource) const { return m_resources[resource].offset; }
+    uint64_t getTransientHeapSize() const { return m_heapSize; }
+    // Sum of the live transients' sizes, i.e. the heap size without aliasing
+    uint64_t getTransientBytes() const { return m_transientBytes; }
+
+private:
+    enum class Access { Read, Write, Modify };
+    struct Use {
+        int resource;
+        Usage usage;
+        Access access;
+    };
+    struct Pass {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<Use> uses;
+        bool sideEffect = false;
+        bool live = false;
+    };
+    struct Resource {
+        std::string name;
+        bool transient = false;
+        Usage initial = Usage::None;
+        Usage final = Usage::None;
+        uint64_t size = 0;
+        uint64_t alignment = 1;
+        // Compile results
+        int firstUse = -1;           // Schedule indices
+        int lastUse = -1;
+        uint64_t offset = UINT64_MAX;
+        Usage lastUsage = Usage::None;
+        uint32_t tailUsages = 0;     // Readers since the last write, or the last writer
+        bool tailWrote = false;
+    };
+
+    void addUse(int pass, int resource, Usage usage, Access access);
+    void cullPasses();
+    void placeTransients();
+    bool sharesMemory(const Resource& a, const Resource& b) const;
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<ScheduledPass> m_schedule;
+    std::vector<Barrier> m_finalBarriers;
+    uint64_t m_heapSize = 0;
+    uint64_t m_transientBytes = 0;
+};
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <map>
+#include <cstdint>
 
 class GameState;
 class VulkanRenderer;
@@ -17,9 +22,27 @@ public:
     // Benchmark mode for CI/CD performance testing
     void setBenchmarkMode(bool enabled, int maxFrames = 500);
 
+    // Headless mode renders offscreen without a window (set before initialize). Captured frames are
+    // written as PPM, and the simulation steps at a fixed 60 Hz so captures are reproducible.
+    void setHeadless(bool headless) { m_headless = headless; }
+    void requestFrameCapture(int frame, const std::string& path) { m_frameCaptures.emplace_back(frame, path); }
+
+    // Latency/throughput tuning (set before initialize). presentMode is "immediate", "mailbox", "fifo"
+    // or "fifo_relaxed"; framesInFlight is 1-3; a frame rate cap of 0 leaves pacing to the present mode.
+    void setPresentMode(const std::string& presentMode) { m_presentMode = presentMode; }
+    void setFramesInFlight(int framesInFlight) { m_framesInFlight = framesInFlight; }
+    void setFrameRateCap(int fps) { m_frameRateCap = fps; }
+    // The world is drawn at this fraction of the window and upscaled; the UI stays at full resolution
+    void setRenderScale(float scale) { m_renderScale = scale; }
+    // On static screens (menu, character selection), drop unchanged frames and sleep in the window
+    // event queue while no key is held. Never applies to benchmark or headless runs.
+    void setReactiveRendering(bool reactive) { m_reactiveRendering = reactive; }
+
 private:
     void update(float deltaTime);
     void render();
+    void recordBenchmarkFrame(float frameSeconds, double cpuMs);
+    void writeBenchmarkSummary() const;
 
     std::unique_ptr<GameState> m_gameState;
     std::unique_ptr<VulkanRenderer> m_renderer;
@@ -29,4 +52,28 @@ private:
     bool m_benchmarkMode = false;
     int m_maxBenchmarkFrames = 500;
     int m_benchmarkFrameCount = 0;
+
+    // Per-frame samples for the benchmark summary JSON (GPU numbers trail by the frames in flight)
+    struct BenchmarkSamples {
+        std::vector<double> frameMs;     // Loop interval, including the frame rate cap
+        std::vector<double> cpuMs;       // Loop work before the frame rate cap sleep
+        std::vector<double> cpuWaitMs;   // Of that, blocked handing the frame to the render thread
+        std::vector<double> gpuMs;
+        std::vector<double> drawCalls;
+        std::vector<double> sprites;
+        std::map<std::string, std::vector<double>> passGpuMs;
+        uint64_t lastStatsFrame = UINT64_MAX;
+    };
+    BenchmarkSamples m_benchmarkSamples;
+
+    // Headless settings
+    bool m_headless = false;
+    std::vector<std::pair<int, std::string>> m_frameCaptures;
+
+    // Presentation settings
+    std::string m_presentMode;  // Empty = renderer default
+    int m_framesInFlight = 0;   // 0 = renderer default
+    int m_frameRateCap = 60;
+    float m_renderScale = 1.0f;
+    bool m_reactiveRendering = true;
 };
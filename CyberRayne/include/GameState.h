@@ -5,8 +5,10 @@
 #include "CharacterSelectionSystem.h"
 #include "MenuSystem.h"
 #include "UIManager.h"
+#include "Camera2D.h"
 
 class World;
+class Map;
 class Player;
 class VulkanRenderer;
 class CharacterSelectionSystem;
@@ -45,6 +47,9 @@ public:
     Player* getPlayer() const { return m_player; }
 
 private:
+    // Follows the player over the current map, kept inside the map's edges
+    void updateCamera(float deltaTime);
+
     State m_currentState;
     World* m_world;
     Player* m_player;
@@ -53,4 +58,6 @@ private:
     MenuSystem* m_menuSystem;
     UIManager* m_uiManager;
     VulkanRenderer* m_renderer;
+    Camera2D m_camera;
+    const Map* m_cameraMap = nullptr;  // Map the camera was last on; a new one cuts instead of panning
 };
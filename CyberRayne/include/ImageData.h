@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Decoded RGBA8 image kept in CPU memory (used for atlas building and uploads). Colour is sRGB
+// encoded; filtering and premultiplication work on linear values, as the GPU does with SRGB formats.
+struct ImageData {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels; // width * height * 4 bytes, rows top to bottom
+    bool premultiplied = false;  // Colour channels already multiplied by alpha
+
+    bool empty() const { return pixels.empty(); }
+
+    // Decode an image file with stb_image, forcing 4 channels. Returns false on failure.
+    static bool loadFromFile(const std::string& path, ImageData& out);
+
+    // Box-filter downscale so that neither edge exceeds maxSize. Returns a copy if already small enough.
+    ImageData downscaledToFit(int maxSize) const;
+
+    // Multiply RGB by alpha in place (no-op if already premultiplied). Sprites blend premultiplied.
+    void premultiplyAlpha();
+
+    // Next mip level: half size (at least 1x1), 2x2 box filter
+    ImageData halfSize() const;
+
+    // This image followed by successively halved levels down to 1x1
+    std::vector<ImageData> buildMipChain() const;
+
+    // Copy this image into dst at (x, y), repeating the edge pixels `extrude` times into the
+    // surrounding padding so bilinear sampling at the borders never reads a neighbour.
+    void blitInto(ImageData& dst, int x, int y, int extrude) const;
+};
@@ -4,12 +4,14 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <cstdint>
 #include "Tile.h"
 
 class Tile;
 class Enemy;
 class NPC;
 class VulkanRenderer;
+struct SpriteInstance;
 
 class Map {
 public:
@@ -19,10 +21,14 @@ public:
     bool initialize();
 #ifndef NO_VULKAN
     void loadTileTextures(VulkanRenderer* renderer);
+    void releaseTileTextures(VulkanRenderer* renderer);
 #endif
     void update(float deltaTime);
 #ifndef NO_VULKAN
-    void render(VulkanRenderer* renderer);
+    // Queues the tiles overlapping viewRect (minX, minY, maxX, maxY in world units, see Camera2D)
+    void render(VulkanRenderer* renderer, const float viewRect[4]);
+    // Every tile as a sprite in world units (fallbackTexture for tiles without one)
+    void buildTileSprites(std::vector<SpriteInstance>& sprites, int fallbackTexture) const;
 #endif
 
     // Tile management
@@ -43,6 +49,8 @@ public:
     const std::string& getName() const { return m_name; }
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
+    // Bumped whenever tiles, tile textures, enemies or NPCs change (for cached sprite sets)
+    uint64_t getRevision() const { return m_revision; }
 
 private:
     std::string m_name;
@@ -54,4 +62,5 @@ private:
     
     // Tile texture indices
     std::map<Tile::TileType, int> m_tileTextures;
+    uint64_t m_revision = 0;
 };
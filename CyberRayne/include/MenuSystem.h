@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include "UITree.h"
 
 class VulkanRenderer;
 
@@ -19,6 +20,7 @@ public:
 
     bool initialize();
     void loadTextures(VulkanRenderer* renderer);
+    void releaseTextures(VulkanRenderer* renderer);
     void update(float deltaTime);
     void render(VulkanRenderer* renderer);
     void handleInput(int key);
@@ -29,9 +31,9 @@ public:
     void resetSelection() { m_optionSelected = false; }
 
 private:
-    void renderMenuBackground(VulkanRenderer* renderer);
-    void renderMenuOptions(VulkanRenderer* renderer);
-    
+    // Lays the menu out once per texture load; render() only replays the baked tree
+    void buildTree();
+
     std::vector<std::string> m_menuOptions;
     MenuItem m_selectedOption;
     bool m_optionSelected;
@@ -46,10 +48,8 @@ private:
     int m_quitButtonTextureIndex;
     int m_cursorTextureIndex;
     int m_highlightTextureIndex;
-    
-    // Positioning constants for menu rendering
-    static constexpr float MENU_START_X = -0.8f;
-    static constexpr float MENU_START_Y = 0.6f;
-    static constexpr float MENU_OPTION_SPACING = 0.2f;
-    static constexpr float HIGHLIGHT_OFFSET_X = -0.1f;
+
+    UITree m_tree;
+    int m_buttonWidgets[4]; // By highlight index: Start, Load, Quit, Settings
+    int m_cursorWidget;
 };
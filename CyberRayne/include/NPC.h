@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include "SpriteAnimation.h"
 
 class NPC {
 public:
@@ -14,6 +15,9 @@ public:
 
     // Setters
     void setPosition(float x, float y) { m_x = x; m_y = y; }
+    // Sprite-sheet clip drawn instead of the plain sprite (taken up when the map's sprites are rebuilt)
+    void setAnimation(const AnimationPlayback& animation) { m_animation = animation; }
+    const AnimationPlayback& getAnimation() const { return m_animation; }
 
     // NPC behavior
     void update(float deltaTime);
@@ -23,5 +27,6 @@ private:
     std::string m_name;
     float m_x;
     float m_y;
+    AnimationPlayback m_animation;
     // Add more NPC-specific properties here
 };
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "SpriteAnimation.h"
 
 #ifndef NO_VULKAN
 class VulkanRenderer;
@@ -29,8 +30,12 @@ public:
 
     bool initialize();
     void update(float deltaTime);
+    // Switches between the idle and walk clips when the player starts or stops moving, starting the
+    // new clip at animationTime (VulkanRenderer::getAnimationTime)
+    void updateAnimation(float animationTime);
 #ifndef NO_VULKAN
     void loadTexture(class VulkanRenderer* renderer);
+    void releaseTexture(class VulkanRenderer* renderer);
     void render(class VulkanRenderer* renderer);
 #else
     void render();
@@ -51,6 +56,8 @@ public:
     float getX() const { return m_x; }
     float getY() const { return m_y; }
     int getTextureIndex() const { return m_textureIndex; }
+    // Clip to draw (clip -1 when the class has no sheet), see updateAnimation
+    const AnimationPlayback& getAnimation() const { return m_animation; }
 
     // Setters
     void setName(const std::string& name) { m_name = name; }
@@ -116,6 +123,11 @@ private:
     float m_moveSpeed; // tiles per second
     
     int m_textureIndex;
+    // Optional sprite sheet (<class>_sheet.png): 4 columns by 2 rows, idle on the top row and
+    // walking on the bottom one
+    int m_idleClip;
+    int m_walkClip;
+    AnimationPlayback m_animation;
 
     std::vector<Item*> m_inventory;
     std::vector<Spell*> m_spells;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Sprite layers, drawn back to front. Each layer decides how the sprites inside it are ordered.
+enum class RenderLayer : uint8_t {
+    Background = 0,
+    Tiles,
+    Entities,
+    UI,
+    Count
+};
+
+enum class LayerOrdering : uint8_t {
+    Submission,  // Call order; later calls draw on top (backgrounds, UI)
+    ByTexture,   // Free to reorder, grouped by texture (non-overlapping tiles)
+    YSorted      // Back to front by the sprite's bottom edge, then by texture (characters)
+};
+
+const char* renderLayerName(RenderLayer layer);
+LayerOrdering renderLayerOrdering(RenderLayer layer);
+// Tiles and entities are queued in world units and placed by the camera; background and UI in NDC
+bool renderLayerUsesCamera(RenderLayer layer);
+
+// Per-frame list of 64-bit sort keys, one per queued sprite. Key layout, most significant first:
+//   [63..56] layer   [55..24] depth (submission sequence or order-preserving float bits)
+//   [23..20] blend mode (pipeline variant, 0 = premultiplied alpha)   [19..0] texture slot
+// Sorting by key orders by layer, then depth, then groups equal-depth sprites by pipeline and texture.
+class RenderQueue {
+public:
+    struct Entry {
+        uint64_t key;
+        uint32_t index;  // Submission index of the sprite
+    };
+
+    static uint64_t makeKey(RenderLayer layer, uint32_t depth, uint32_t blendMode, uint32_t texture);
+    // Monotonic mapping of a float onto uint32 (negative values included)
+    static uint32_t depthFromFloat(float depth);
+    static RenderLayer layerFromKey(uint64_t key) { return static_cast<RenderLayer>(key >> 56); }
+    static uint32_t textureFromKey(uint64_t key) { return static_cast<uint32_t>(key & 0xFFFFF); }
+
+    void clear() { m_entries.clear(); }
+    void reserve(size_t count) { m_entries.reserve(count); }
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+
+    void push(uint64_t key) { m_entries.push_back({key, static_cast<uint32_t>(m_entries.size())}); }
+
+    // Stable LSD radix sort, 8 bits per pass. Passes where every key has the same byte (usually most
+    // of them: one blend mode, few layers) are skipped, so a typical frame costs two to four passes.
+    void sort();
+    const std::vector<Entry>& getEntries() const { return m_entries; }
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_scratch;
+};
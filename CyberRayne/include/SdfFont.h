@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ImageData.h"
+
+// Signed-distance-field font built at startup from a built-in 5x7 pixel font covering printable
+// ASCII. Every glyph cell of the atlas stores the exact distance to the glyph's pixel outline in
+// alpha (0.5 on the edge, 1 pixel of the font = DISTANCE_SPREAD), so glyphs stay sharp at any size.
+// Pure CPU code (no Vulkan), so it can be unit tested on its own.
+class SdfFont {
+public:
+    // Font units: one pixel of the 5x7 source font. Layouts are in font units, top-left origin, +y down.
+    static const int GLYPH_COLUMNS = 5;
+    static const int GLYPH_ROWS = 7;
+    static const int ADVANCE = 6;       // Glyph plus one column of spacing
+    static const int LINE_HEIGHT = 9;   // Glyph plus two rows of spacing
+    static const int CELL_PADDING = 1;  // Font units of distance field around each glyph
+    static constexpr float DISTANCE_SPREAD = 1.0f; // Font units from the edge to 0 or 1
+
+    struct GlyphQuad {
+        float x, y, width, height; // Padded cell, in font units
+        float uvRect[4];           // u0, v0, u1, v1 in the atlas
+    };
+
+    struct TextLayout {
+        std::vector<GlyphQuad> glyphs; // Spaces and line breaks emit nothing
+        float width = 0.0f;            // Widest line, without the trailing spacing column
+        float height = 0.0f;           // Lines * GLYPH_ROWS plus the spacing between them
+    };
+
+    // texelsPerUnit: atlas resolution of one font unit; the atlas grows with its square
+    explicit SdfFont(int texelsPerUnit = 8);
+
+    // RGBA8 atlas: white, distance in alpha
+    const ImageData& getAtlas() const { return m_atlas; }
+
+    // Characters outside printable ASCII are drawn as '?'; '\n' starts a new line
+    TextLayout layout(const std::string& text) const;
+
+private:
+    static const char FIRST_CHAR = ' ';
+    static const char LAST_CHAR = '~';
+    static const int ATLAS_COLUMNS = 16;
+
+    void buildAtlas();
+    void buildGlyph(int glyph, int cellX, int cellY);
+
+    int m_texelsPerUnit;
+    int m_cellWidth;   // Texels
+    int m_cellHeight;
+    ImageData m_atlas;
+};
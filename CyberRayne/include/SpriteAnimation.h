@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Sprite-sheet animation. A clip is a list of frames (a UV rect on its sheet and how long it shows)
+// plus a loop mode, registered once per sheet. An animated sprite instance carries only the clip id,
+// its start time and a playback rate; the vertex shader picks the frame from the frame's global
+// time, so animating any number of sprites costs nothing on the CPU once they are queued (and
+// nothing at all for sprite sets, which are uploaded once).
+//
+// The renderer ships every clip to the GPU as one table of vec4s (packAnimationTable):
+//   vec4 clip[i]        uint bits: first frame vec4, frame count, loop mode, float bits of duration
+//   vec4 frame[2f]      uvRect (u0, v0, u1, v1)
+//   vec4 frame[2f + 1]  x = end time of the frame within the clip, yzw unused
+// selectPackedAnimationFrame() is a CPU reference model of the vertex shader's animatedUvRect():
+// the same steps on the packed table, written separately in C++. Tests check it (and so the packing)
+// against selectAnimationFrame(); they do not run the GLSL, so keep the two in step by hand.
+
+enum class AnimationLoop : uint32_t {
+    Once,       // Holds the last frame
+    Loop,
+    PingPong    // Forwards then backwards
+};
+
+struct AnimationFrame {
+    float uvRect[4];    // u0, v0, u1, v1 on the sheet
+    float duration;     // Seconds
+};
+
+// What an entity is playing: the sheet texture, a clip on it (-1 for none) and when it started on
+// the renderer's animation clock
+struct AnimationPlayback {
+    int sheetTexture = -1;
+    int clip = -1;
+    float startTime = 0.0f;
+    float rate = 1.0f;
+};
+
+struct AnimationClip {
+    int texture = -1;   // Sheet the frames are on
+    std::vector<AnimationFrame> frames;
+    AnimationLoop loop = AnimationLoop::Loop;
+
+    float duration() const;
+};
+
+// count frames of a columns x rows sheet, reading cells left to right and top to bottom from
+// firstCell, each shown for frameDuration seconds
+std::vector<AnimationFrame> gridAnimationFrames(int columns, int rows, int firstCell, int count, float frameDuration);
+
+// Frame index of the clip showing time seconds after it started (0 for an empty clip)
+int selectAnimationFrame(const AnimationClip& clip, float time);
+
+// Frame index the packed table gives for clip at time seconds after it started: the reference
+// model of vertex_shader.vert (see above). 0 for an empty clip or a clip outside the table.
+int selectPackedAnimationFrame(const std::vector<float>& table, uint32_t clip, float time);
+
+// vec4s packAnimationTable() writes for these clips
+size_t animationTableVec4Count(const std::vector<AnimationClip>& clips);
+
+// Packs the clips into table (4 floats per vec4) in the layout above. remapUV, when set, maps each
+// frame's sheet-relative rect to where the sheet really is (an atlas region) before it is stored.
+using AnimationUVRemap = std::function<void(const AnimationClip& clip, const float in[4], float out[4])>;
+void packAnimationTable(const std::vector<AnimationClip>& clips, std::vector<float>& table,
+                        const AnimationUVRemap& remapUV = nullptr);
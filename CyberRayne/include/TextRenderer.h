@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SdfFont.h"
+
+class VulkanRenderer;
+struct SpriteInstance;
+
+// Screen text drawn from the SDF font atlas. Glyphs are queued as ordinary sprite instances (with
+// SPRITE_DISTANCE_FIELD_FLAG) in the current render layer, so text shares the layer's instanced
+// draw with its sprites and a screen full of text costs no extra draws or texture uploads.
+// Layouts are cached per string; drawing an unchanged string only scales and queues its quads.
+class TextRenderer {
+public:
+    TextRenderer();
+    ~TextRenderer();
+
+    // Builds the font atlas on first use and uploads it
+    void initialize(VulkanRenderer* renderer);
+    void release(VulkanRenderer* renderer);
+    bool isReady() const { return m_fontTexture >= 0; }
+
+    // Draws text with its top-left corner at (leftPx, topPx). pixelHeight is the height of a capital
+    // letter; color is straight (not premultiplied) RGBA.
+    void drawText(VulkanRenderer* renderer, const std::string& text, float leftPx, float topPx,
+                  float pixelHeight, const float color[4]);
+    // Same glyphs appended to a sprite list (unresolved handles) for a screen of the given size
+    void appendText(std::vector<SpriteInstance>& out, const std::string& text, float leftPx, float topPx,
+                    float pixelHeight, const float color[4], float screenWidth, float screenHeight);
+    // Size the same text would take on screen, in pixels
+    void measureText(const std::string& text, float pixelHeight, float& widthPx, float& heightPx);
+
+private:
+    const SdfFont::TextLayout& getLayout(const std::string& text);
+
+    // Strings that change every frame (timers, counters) would grow the cache without bound; it is
+    // simply emptied when full and the strings still on screen are laid out again
+    static const size_t MAX_CACHED_LAYOUTS = 256;
+
+    std::unique_ptr<SdfFont> m_font;
+    int m_fontTexture;
+    std::unordered_map<std::string, SdfFont::TextLayout> m_layoutCache;
+    std::vector<SpriteInstance> m_scratch; // drawText's glyphs before queueing
+};
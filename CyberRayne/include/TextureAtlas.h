@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Skyline bottom-left rectangle packer used to build texture atlas pages.
+// Pure CPU code (no Vulkan), so it can be unit tested on its own.
+class TextureAtlas {
+public:
+    struct Placement {
+        int page = -1;  // Atlas page the rectangle landed on (-1 if it could not be placed)
+        int x = 0;      // Top-left of the usable (unpadded) area, in pixels
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    struct PageSize {
+        int width = 0;
+        int height = 0;
+    };
+
+    // maxPageSize: largest page edge (clamped by the device limit by the caller)
+    // padding: empty border kept around every rectangle to avoid filtering bleed
+    TextureAtlas(int maxPageSize, int padding);
+
+    // Pack all rectangles at once. Rectangles are sorted by height internally for a tighter fit,
+    // the returned placements are in the same order as the input sizes.
+    std::vector<Placement> pack(const std::vector<PageSize>& sizes);
+
+    // Final page dimensions after packing (trimmed to the used area)
+    const std::vector<PageSize>& getPages() const { return m_pages; }
+
+    int getPadding() const { return m_padding; }
+    int getMaxPageSize() const { return m_maxPageSize; }
+
+private:
+    struct SkylineNode {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page {
+        int width;
+        int height;
+        int usedWidth = 0;
+        int usedHeight = 0;
+        std::vector<SkylineNode> skyline;
+    };
+
+    int m_maxPageSize;
+    int m_padding;
+    std::vector<PageSize> m_pages;
+
+    static bool findPosition(const Page& page, int width, int height, int& bestX, int& bestY, size_t& bestNode);
+    static void addSkylineLevel(Page& page, size_t nodeIndex, int x, int y, int width, int height);
+    Page createPage(int pageWidth) const;
+};
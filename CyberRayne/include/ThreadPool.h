@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+// Fixed-size pool of worker threads running fire-and-forget jobs (asset decoding, command recording).
+// Jobs must not touch shared Vulkan objects: decoders hand their results back to the render thread,
+// and recording jobs bring their own command pool.
+class ThreadPool {
+public:
+    // threadCount == 0 picks hardware_concurrency - 1 (at least one worker)
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Jobs queued but not started yet
+    size_t getQueuedJobCount() const;
+    size_t getThreadCount() const { return m_workers.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_jobs;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping = false;
+};
@@ -2,8 +2,11 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 
 #include <memory>
+#include "TextRenderer.h"
+#include "UITree.h"
 
 class VulkanRenderer;
 class Player;
@@ -33,6 +36,7 @@ public:
 
     void initialize(VulkanRenderer* renderer);
     void loadTextures(VulkanRenderer* renderer);
+    void releaseTextures(VulkanRenderer* renderer);
     
     // Battle UI methods
     void renderBattleUI(VulkanRenderer* renderer, Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies);
@@ -49,13 +53,14 @@ public:
     int getSelectedSpellIndex() const { return m_selectedSpellIndex; }
     void resetAction();
 
-    // Legacy/Console methods (to be deprecated/removed or adapted)
+    // Battle log: shown on screen (last MAX_MESSAGES lines) and echoed to the console
     void displayMessage(const std::string& message);
     
 private:
-    void renderBattleMenu(VulkanRenderer* renderer);
-    void renderStats(VulkanRenderer* renderer, Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies);
-    void renderCursor(VulkanRenderer* renderer);
+    // Widgets are laid out once per texture load; per frame only changed values reach the tree
+    void buildTree();
+    void updateStats(Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies);
+    void updateMessages();
 
     BattleMenuState m_battleState;
     BattleAction m_selectedAction;
@@ -71,7 +76,20 @@ private:
     int m_backgroundTextureIndex; // Reusing menu background for now or a new one
     int m_buttonTextureIndices[4]; // 0: Attack/Start, 1: Magic/Load, etc. (Need to map correctly)
     
+    TextRenderer m_textRenderer;
+    std::deque<std::string> m_messages;
+
+    UITree m_tree;
+    int m_buttonWidgets[4];
+    int m_cursorWidget;
+    int m_playerTextWidget;
+    int m_playerBarWidget;
+    std::vector<int> m_enemyWidgets;   // One row per living enemy, grown on demand
+    std::vector<int> m_messageWidgets; // By age, newest first
+    
     // Layout constants
     const int BUTTON_WIDTH = 300;
     const int BUTTON_HEIGHT = 110;
+    const float TEXT_HEIGHT = 21.0f;       // Capital letter height in pixels
+    const size_t MAX_MESSAGES = 4;
 };
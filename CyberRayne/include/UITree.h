@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "VulkanRenderer.h"
+
+class TextRenderer;
+
+// Where a widget sits: anchor is a fraction of the screen (0,0 top-left, 1,1 bottom-right), offset
+// and size are pixels added on top, relativeSize is a fraction of the screen added to size.
+struct UIRect {
+    float anchor[2] = {0.0f, 0.0f};
+    float offset[2] = {0.0f, 0.0f};
+    float size[2] = {0.0f, 0.0f};
+    float relativeSize[2] = {0.0f, 0.0f};
+
+    static UIRect pixels(float anchorX, float anchorY, float x, float y, float width, float height) {
+        UIRect rect;
+        rect.anchor[0] = anchorX;
+        rect.anchor[1] = anchorY;
+        rect.offset[0] = x;
+        rect.offset[1] = y;
+        rect.size[0] = width;
+        rect.size[1] = height;
+        return rect;
+    }
+    static UIRect fullScreen() {
+        UIRect rect;
+        rect.relativeSize[0] = rect.relativeSize[1] = 1.0f;
+        return rect;
+    }
+};
+
+// Retained-mode UI: widgets are created once and changed through setters. Layout and the baked
+// sprite list are only rebuilt when a setter actually changes something or the swapchain is resized;
+// every other frame render() hands the cached, pre-resolved sprites to the renderer in one copy.
+// Widgets bake in creation order and draw in the current render layer (UI keeps call order).
+// Texture handles belong to the caller: re-set or rebuild the tree after reloading them.
+class UITree {
+public:
+    enum class WidgetType {
+        Image,
+        Button,  // Image with a centred text label
+        Bar,     // Background plus a left-aligned fill of value * width (default texture, tinted)
+        Text,
+        Cursor   // Texture to the left of its target widget; a highlight behind it without one
+    };
+
+    explicit UITree(TextRenderer* textRenderer = nullptr) : m_textRenderer(textRenderer) {}
+
+    void setTextRenderer(TextRenderer* textRenderer) { m_textRenderer = textRenderer; m_dirty = true; }
+
+    // Each returns the widget id used by the setters
+    int addImage(const UIRect& rect, int texture);
+    int addButton(const UIRect& rect, int texture, const std::string& label, float labelHeight);
+    int addBar(const UIRect& rect, const float fillColor[4], const float backColor[4]);
+    // align: 0 puts the anchor point at the text's left edge, 0.5 centre, 1 right edge
+    int addText(const UIRect& rect, const std::string& text, float height, const float color[4], float align = 0.0f);
+    int addCursor(int texture, float size, float gap, int target);
+    void clear();
+
+    // Setters only invalidate the bake when the value differs, so calling them every frame is cheap
+    void setVisible(int widget, bool visible);
+    void setTexture(int widget, int texture);
+    void setText(int widget, const std::string& text);
+    void setColor(int widget, const float color[4]);
+    void setValue(int widget, float value);
+    void setCursorTarget(int cursor, int target);
+
+    void render(VulkanRenderer* renderer);
+
+    uint32_t getBakeCount() const { return m_bakeCount; }
+
+private:
+    struct Widget {
+        WidgetType type = WidgetType::Image;
+        UIRect rect;
+        bool visible = true;
+        int texture = -1;
+        std::string text;
+        float textHeight = 0.0f;
+        float align = 0.0f;
+        float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        float backColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        float value = 1.0f;
+        int target = -1;
+        // Layout result in pixels
+        float left = 0.0f, top = 0.0f, width = 0.0f, height = 0.0f;
+    };
+
+    int addWidget(const Widget& widget);
+    bool isValid(int widget) const { return widget >= 0 && widget < static_cast<int>(m_widgets.size()); }
+    void layout(float screenWidth, float screenHeight);
+    void bake(float screenWidth, float screenHeight);
+    void bakeQuad(float left, float top, float width, float height, int texture, const float tint[4],
+                  float screenWidth, float screenHeight);
+    void resolve(VulkanRenderer* renderer);
+
+    TextRenderer* m_textRenderer;
+    std::vector<Widget> m_widgets;
+    bool m_dirty = true;
+    VkExtent2D m_extent{0, 0};
+    std::vector<SpriteInstance> m_baked;     // Texture handles, as created
+    std::vector<SpriteInstance> m_resolved;  // Bindless slots, what render() queues
+    uint64_t m_resolvedRevision = 0;
+    uint32_t m_bakeCount = 0;
+};
@@ -8,6 +8,23 @@
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <map>
+#include <chrono>
+#include "ImageData.h"
+#include "CookedTexture.h"
+#include "ThreadPool.h"
+#include "RenderQueue.h"
+#include "DeviceAllocator.h"
+#include "FrameGraph.h"
+#include "Camera2D.h"
+#include "SpriteAnimation.h"
 
 // Vertex structure for our sprites
 struct Vertex {
@@ -66,15 +83,128 @@ struct UniformBufferObject {
     float model[16];
     float view[16];
     float proj[16];
+    float time;                   // Animation clock (getAnimationTime) for animated sprites
+    uint32_t animationClipCount;  // Clips in the animation table; other clip ids show the whole texture
+    uint32_t lit;                 // Layer takes the lighting (world layers when the frame has any)
+    uint32_t lightCount;          // Lights binned into the tile lists this frame
+    float ambient[4];             // RGB light everywhere on lit layers
+    uint32_t lightTileCountX;     // Row length of the tile lists
+    uint32_t padding[3];
+};
+
+// Dynamic point light on the world layers (renderLayerUsesCamera), in world units. It falls off
+// quadratically from intensity at the centre to nothing at radius, on top of the ambient light.
+struct PointLight {
+    float position[2];
+    float radius;
+    float intensity;
+    float color[4];  // RGB, alpha unused
 };
 
-// Structure to hold sprite transform data
-struct SpriteTransform {
-    float x;
-    float y;
-    float width;
-    float height;
-    int textureIndex;
+// Sampling mode chosen per texture at load time. Linear textures get a full mip chain and trilinear
+// filtering; Nearest keeps pixel art crisp (single level, no filtering).
+enum class TextureFilter {
+    Linear,
+    Nearest
+};
+
+// Set in SpriteInstance::textureIndex for text glyphs: the texture holds a signed distance field in
+// alpha (0.5 on the outline) that the fragment shader turns into antialiased coverage
+static const int32_t SPRITE_DISTANCE_FIELD_FLAG = 0x40000000;
+// Set in SpriteInstance::textureIndex for sprite-sheet animation (SpriteInstance::makeAnimated):
+// uvRect then holds the clip id, start time and playback rate, and the vertex shader picks the frame
+static const int32_t SPRITE_ANIMATED_FLAG = 0x20000000;
+// Bits of SpriteInstance::textureIndex that are flags rather than the texture
+static const int32_t SPRITE_FLAGS = SPRITE_DISTANCE_FIELD_FLAG | SPRITE_ANIMATED_FLAG;
+
+// Per-instance sprite data, streamed to the GPU once per frame (vertex binding 1)
+struct SpriteInstance {
+    float position[2];     // Centre x, y: world units on camera layers (renderLayerUsesCamera), else NDC
+    float size[2];         // Width, height in the same units
+    float uvRect[4];       // u0, v0, u1, v1 (relative to the texture handle's region); animated
+                           // sprites: clip id, start time, playback rate, unused
+    float tint[4];         // RGBA multiplier
+    int32_t textureIndex;  // Texture handle from loadTexture (resolved to a bindless slot when queued),
+                           // optionally with SPRITE_DISTANCE_FIELD_FLAG or SPRITE_ANIMATED_FLAG
+
+    // Full-texture, untinted sprite
+    static SpriteInstance make(float x, float y, float width, float height, int textureIndex) {
+        SpriteInstance instance{};
+        instance.position[0] = x;
+        instance.position[1] = y;
+        instance.size[0] = width;
+        instance.size[1] = height;
+        instance.uvRect[2] = 1.0f;
+        instance.uvRect[3] = 1.0f;
+        instance.tint[0] = instance.tint[1] = instance.tint[2] = instance.tint[3] = 1.0f;
+        instance.textureIndex = textureIndex;
+        return instance;
+    }
+
+    // Untinted sprite playing clip (from createAnimationClip) on its sheet, startTime being the
+    // animation clock (getAnimationTime) at which the clip's first frame shows. Without a sheet or a
+    // clip it is a plain sprite of the whole sheet (the default texture when there is no sheet):
+    // a negative handle cannot carry the flag, and its clip fields would be read as UVs.
+    static SpriteInstance makeAnimated(float x, float y, float width, float height, int sheetTexture,
+                                       int clip, float startTime, float rate = 1.0f) {
+        if (sheetTexture < 0 || clip < 0) {
+            return make(x, y, width, height, sheetTexture);
+        }
+        SpriteInstance instance = make(x, y, width, height, sheetTexture | SPRITE_ANIMATED_FLAG);
+        instance.uvRect[0] = static_cast<float>(clip);
+        instance.uvRect[1] = startTime;
+        instance.uvRect[2] = rate;
+        instance.uvRect[3] = 0.0f;
+        return instance;
+    }
+    static SpriteInstance makeAnimated(float x, float y, float width, float height, const AnimationPlayback& playback) {
+        return makeAnimated(x, y, width, height, playback.sheetTexture, playback.clip, playback.startTime, playback.rate);
+    }
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(SpriteInstance);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        return bindingDescription;
+    }
+
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(5);
+
+        // Instance position
+        attributeDescriptions[0].binding = 1;
+        attributeDescriptions[0].location = 2;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[0].offset = offsetof(SpriteInstance, position);
+
+        // Instance size
+        attributeDescriptions[1].binding = 1;
+        attributeDescriptions[1].location = 3;
+        attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[1].offset = offsetof(SpriteInstance, size);
+
+        // Instance UV rectangle
+        attributeDescriptions[2].binding = 1;
+        attributeDescriptions[2].location = 4;
+        attributeDescriptions[2].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attributeDescriptions[2].offset = offsetof(SpriteInstance, uvRect);
+
+        // Instance tint
+        attributeDescriptions[3].binding = 1;
+        attributeDescriptions[3].location = 5;
+        attributeDescriptions[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        attributeDescriptions[3].offset = offsetof(SpriteInstance, tint);
+
+        // Instance texture slot in the bindless texture array
+        attributeDescriptions[4].binding = 1;
+        attributeDescriptions[4].location = 6;
+        attributeDescriptions[4].format = VK_FORMAT_R32_UINT;
+        attributeDescriptions[4].offset = offsetof(SpriteInstance, textureIndex);
+
+        return attributeDescriptions;
+    }
 };
 
 struct SwapChainSupportDetails {
@@ -83,24 +213,172 @@ struct SwapChainSupportDetails {
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+// GPU time of one render layer (see setRenderLayer)
+struct GpuPassTiming {
+    std::string label;
+    double gpuMs = 0.0;
+};
+
+// Timing of one completed frame. GPU times come from timestamp queries and are read back without
+// stalling once the frame's fence has signalled, so they trail the frame being recorded.
+struct FrameStats {
+    uint64_t frameNumber = 0;      // Frame these numbers describe
+    double cpuWaitMs = 0.0;        // Render thread blocked on the frame-in-flight fence (CPU ahead of GPU)
+    double cpuRecordMs = 0.0;      // Rest of drawFrame up to the submit: uploads and recording
+    double gpuFrameMs = 0.0;       // Render pass start to end on the GPU
+    bool gpuTimingValid = false;   // False until the first frame completes or without timestamp support
+    uint32_t drawCalls = 0;
+    uint32_t sprites = 0;
+    uint32_t textureSwitches = 0;  // Adjacent sorted sprites sampling different textures
+    std::vector<GpuPassTiming> passes;
+};
+
 class VulkanRenderer {
 public:
     VulkanRenderer();
     ~VulkanRenderer();
 
+    // Headless mode (set before initialize): no window, surface or swapchain. Frames are rendered
+    // into offscreen images on any ICD (lavapipe included) and can be read back with
+    // requestFrameCapture.
+    void setHeadless(bool headless) { m_headless = headless; }
+    bool isHeadless() const { return m_headless; }
+    // Headless only: write the given frame (0-based) to a binary PPM once it has rendered
+    void requestFrameCapture(uint64_t frameNumber, const std::string& path);
+    // Presentation settings (set before initialize). The default is MAILBOX with two frames in flight;
+    // an unsupported mode falls back to FIFO, which every device has.
+    void setPresentMode(VkPresentModeKHR mode) { m_requestedPresentMode = mode; }
+    VkPresentModeKHR getPresentMode() const { return m_presentMode; }
+    void setFramesInFlight(uint32_t count);
+    uint32_t getFramesInFlight() const { return m_framesInFlight; }
+    // "immediate", "mailbox", "fifo" or "fifo_relaxed"
+    static bool parsePresentMode(const std::string& name, VkPresentModeKHR& mode);
+    static const char* presentModeName(VkPresentModeKHR mode);
+    // Render scale (set before initialize, 0.25-1): the world layers are drawn at this fraction of
+    // the swapchain size and upscaled, then the UI is drawn on top at native resolution
+    void setRenderScale(float scale);
+    float getRenderScale() const { return m_renderScale; }
+
+    // Input-to-photon latency probe: call when input for the next frame is sampled. The frame is
+    // followed through submit and present (to the display with VK_KHR_present_wait, otherwise to
+    // the return of vkQueuePresentKHR).
+    void markInputSampled() { m_inputSampleTime = std::chrono::steady_clock::now(); m_hasInputSample = true; }
+    void printLatencyReport() const;
     bool initialize(uint32_t width, uint32_t height, const std::string& title);
     void cleanup();
+    // Ends the frame being queued: hands everything queued since the last call to the render thread,
+    // which records, submits and presents it while the caller goes on to the next frame. Blocks only
+    // while the render thread is still busy with the frame before, so the caller stays at most one
+    // frame ahead of it. All other methods belong to the calling (game) thread.
     void render();
+    // Blocks until the render thread has submitted every frame handed to it
+    void waitForRenderThread();
+    // How long the last render() call blocked on the render thread
+    double getLastHandoffWaitMs() const { return m_lastHandoffWaitMs; }
+    // Reactive rendering, for static screens: render() hashes the queued sprite stream and drops the
+    // frame when it matches the last frame drawn, so nothing is recorded or presented. The window
+    // keeps its last image; exposing or restoring it forces a redraw.
+    void setReactiveRendering(bool enabled);
+    bool isReactiveRendering() const { return m_reactiveRendering; }
+    // True when the last render() call dropped an unchanged frame
+    bool wasFrameSkipped() const { return m_frameSkipped; }
+    uint64_t getSkippedFrameCount() const { return m_skippedFrameCount; }
+    // Sleeps until a window event arrives or the timeout passes (idling on a static screen)
+    void waitForEvents(double timeoutSeconds);
     bool isRunning() const { return m_running; }
     void renderSprite(float x, float y, float width, float height);
     
     // New methods for texture management
     void createDefaultTexture();
-    int loadTexture(const std::string& path);
+    // Loads are cached by canonical path: a repeated request returns the existing handle with one
+    // more reference. Every successful load should be paired with releaseTexture().
+    int loadTexture(const std::string& path, TextureFilter filter = TextureFilter::Linear);
+    // Texture atlas batching: textures loaded between begin/end are packed into shared atlas pages.
+    // Handles returned inside the batch are valid immediately and show the default texture until
+    // endTextureAtlas() uploads the pages. maxEntrySize > 0 downscales larger images to that edge.
+    void beginTextureAtlas(int maxEntrySize = 0);
+    void endTextureAtlas();
+    // Asynchronous loading: returns a handle at once that draws the default texture until the file
+    // has been decoded on a worker thread and its upload fence has signalled. Inside an atlas batch
+    // the decode is deferred and the whole batch is packed off the render thread by endTextureAtlas().
+    // Nearest-filtered textures always get their own texture, even inside an atlas batch.
+    int loadTextureAsync(const std::string& path, TextureFilter filter = TextureFilter::Linear);
+    // Texture from pixels generated at runtime (e.g. a font atlas). Not cached by path; pair with
+    // releaseTexture() like any other handle. Returns -1 when the texture array is full.
+    int loadTextureFromImage(const ImageData& image, TextureFilter filter = TextureFilter::Linear);
+    // True once the handle's texture is resident (or its load failed and it keeps the default)
+    bool isTextureReady(int handle) const;
+    // Drop one reference to a handle. The GPU texture is freed once no handle uses it any more and
+    // the frames that may still sample it have completed. The default texture (0) is never freed.
+    void releaseTexture(int handle);
+    // Upload batching: every buffer/texture upload between begin/end is recorded into one command
+    // buffer, staged through the persistent staging ring and submitted once with one fence.
+    // Batches nest; uploads outside a batch get an implicit one each. Nothing waits for the GPU,
+    // the staging space is reclaimed once the batch's fence has signalled.
+    void beginUploadBatch();
+    void endUploadBatch();
     void setCurrentTexture(int textureIndex);
+    int getCurrentTexture() const { return m_currentTextureIndex; }
     void renderSpriteWithTexture(float x, float y, float width, float height, int textureIndex);
     // Convenience: render using pixel coordinates (top-left in pixels)
     void renderSpritePixelsWithTexture(int leftPx, int topPx, int widthPx, int heightPx, int textureIndex);
+    // Queue a fully specified sprite instance (UV sub-rectangle, tint)
+    void renderSpriteInstance(const SpriteInstance& instance);
+    // Pre-resolved sprite lists (retained UI): resolveSpriteInstance maps a handle to its bindless
+    // slot and UV region once; the result stays valid until getTextureRegionRevision() changes.
+    // renderResolvedSprites then queues the whole list with one copy in the current layer.
+    SpriteInstance resolveSpriteInstance(const SpriteInstance& instance) const;
+    uint64_t getTextureRegionRevision() const { return m_textureRegionRevision; }
+    void renderResolvedSprites(const std::vector<SpriteInstance>& instances);
+    // Layer for the sprites queued after this call (resets to Background every frame). Before
+    // recording, sprites are radix-sorted by layer, then by the layer's ordering (see RenderQueue.h);
+    // each layer is drawn as its own instanced draw, timed on the GPU and labelled for debuggers.
+    void setRenderLayer(RenderLayer layer) { m_currentLayer = layer; }
+    // Camera for the world layers of the frame being queued (kept until changed). Its viewport is
+    // set to the swapchain size, so getCamera() can be asked what is visible.
+    void setCamera(const Camera2D& camera);
+    const Camera2D& getCamera() const { return m_camera; }
+    // GPU-culled sprite sets: the instances live in device memory and are uploaded once. Every frame
+    // a compute pass culls them against a rect, compacts the survivors and writes the indirect draw,
+    // so the CPU cost of drawing a set doesn't depend on its size. Survivors come out in no fixed
+    // order and are never Y-sorted with queued sprites, so sets suit sprites that don't overlap
+    // (tiles); characters belong in the render queue.
+    // createSpriteSet returns -1 when GPU culling is unavailable (cull.spv missing) or all
+    // MAX_SPRITE_SETS are in use; callers then queue their sprites as usual.
+    bool isGpuCullingAvailable() const { return m_cullPipeline != VK_NULL_HANDLE; }
+    int createSpriteSet(const std::vector<SpriteInstance>& instances);
+    void destroySpriteSet(int spriteSet);
+    // Draws the set this frame in the current render layer, ahead of that layer's queued sprites.
+    // Sprites whose bounds don't overlap the rect (in the layer's units, so world units on camera
+    // layers: Camera2D::getVisibleRect) are culled.
+    void drawSpriteSet(int spriteSet, float minX, float minY, float maxX, float maxY);
+    // Lights for the frame being queued (cleared every frame, like sprites). A compute pass bins
+    // them into LIGHT_TILE_SIZE pixel tiles and the sprite fragment shader only walks its tile's
+    // list, so shading cost follows the lights per tile (at most MAX_LIGHTS_PER_TILE), not the total.
+    // Lights past MAX_LIGHTS in one frame are dropped. Without light_cull.spv only ambient applies.
+    void addLight(const PointLight& light);
+    // Light the world layers get everywhere; white (the default) leaves them as drawn
+    void setAmbientLight(float r, float g, float b);
+    bool isLightCullingAvailable() const { return m_lightCullPipeline != VK_NULL_HANDLE; }
+    // Sprite-sheet animation (see SpriteAnimation.h). Clips are registered once and live as long as
+    // their sheet: releasing the sheet's last handle drops them, and their ids may be handed out
+    // again. The returned id goes into SpriteInstance::makeAnimated. Frame UVs are relative to the
+    // sheet texture, which may sit in an atlas. Registering an identical clip again returns the
+    // existing id. Returns -1 when the table is full.
+    int createAnimationClip(int sheetTexture, const std::vector<AnimationFrame>& frames, AnimationLoop loop);
+    // The clock animated sprites run on. Advanced by the game loop, so headless runs (fixed step)
+    // stay deterministic.
+    void advanceAnimationTime(float deltaTime) { m_animationTime += deltaTime; }
+    float getAnimationTime() const { return static_cast<float>(m_animationTime); }
+    // Most recent frame whose GPU timings have been read back (a copy: the render thread updates it)
+    FrameStats getFrameStats() const;
+    // Device memory usage across the allocator's blocks and dedicated allocations
+    DeviceAllocator::Stats getMemoryStats() const { return m_deviceAllocator.getStats(); }
+    // Moves live textures out of sparsely used memory blocks so the blocks can be released.
+    // Runs automatically after released textures are freed (e.g. a map unloading its tiles).
+    void defragmentTextures();
+    // Wall time from the start of initialize to the first submitted frame (0 until then)
+    double getStartupToFirstFrameMs() const { return m_startupToFirstFrameMs; }
     // Accessor for current swapchain extent (used for pixel -> NDC conversions)
     VkExtent2D getSwapchainExtent() const { return m_swapChainExtent; }
     // Accessor for assets base directory detected at init
@@ -111,9 +389,33 @@ public:
 #endif
 
 private:
-    const int MAX_FRAMES_IN_FLIGHT = 2;
+    static const uint32_t MAX_SUPPORTED_FRAMES_IN_FLIGHT = 3;
+    uint32_t m_framesInFlight = 2;
     size_t m_currentFrame = 0;
 
+    // Presentation
+    VkPresentModeKHR m_requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    VkPresentModeKHR m_presentMode = VK_PRESENT_MODE_FIFO_KHR;   // What the swapchain actually uses
+    bool m_presentWaitSupported = false;                         // VK_KHR_present_id + VK_KHR_present_wait
+    PFN_vkWaitForPresentKHR m_vkWaitForPresentKHR = nullptr;
+    uint64_t m_presentId = 0;
+
+    // Latency probe. Samples are kept in fixed-size rings so long sessions don't grow memory.
+    struct PendingLatencySample {
+        uint64_t presentId;
+        std::chrono::steady_clock::time_point inputTime;
+    };
+    static const size_t LATENCY_SAMPLE_CAPACITY = 4096;
+    std::chrono::steady_clock::time_point m_inputSampleTime;
+    bool m_hasInputSample = false;
+    std::deque<PendingLatencySample> m_pendingLatencySamples; // Presented, not yet on screen
+    std::vector<double> m_inputToSubmitMs;   // Input sampled -> vkQueuePresentKHR returned (or submit, headless)
+    std::vector<double> m_inputToDisplayMs;  // Input sampled -> image shown (present wait only)
+    size_t m_inputToSubmitCount = 0;
+    size_t m_inputToDisplayCount = 0;
+    void recordLatencySample(std::vector<double>& samples, size_t& count, std::chrono::steady_clock::time_point inputTime);
+    void pollPresentedFrames();
+
     // Window variables
 #ifdef _WIN32
     HWND m_window;
@@ -124,13 +426,14 @@ private:
     std::string m_windowTitle;
     uint32_t m_windowWidth;
     uint32_t m_windowHeight;
-    bool m_running;
+    std::atomic<bool> m_running;
 
     // Vulkan variables
     VkInstance m_instance;
     VkDebugUtilsMessengerEXT m_debugMessenger;
     VkPhysicalDevice m_physicalDevice;
     VkDevice m_device;
+    DeviceAllocator m_deviceAllocator;
     VkQueue m_graphicsQueue;
     uint32_t m_graphicsQueueFamilyIndex;
     VkSurfaceKHR m_surface;
@@ -139,11 +442,44 @@ private:
     std::vector<VkImageView> m_swapChainImageViews;
     VkFormat m_swapChainImageFormat;
     VkExtent2D m_swapChainExtent;
-    VkRenderPass m_renderPass;
+    VkRenderPass m_renderPass;                        // Clears its attachment (world pass)
+    VkRenderPass m_loadRenderPass = VK_NULL_HANDLE;   // Compatible with m_renderPass, keeps the contents
     std::vector<VkFramebuffer> m_framebuffers;
-    VkCommandPool m_commandPool;
+    VkCommandPool m_commandPool;          // Frame command buffers (render thread)
+    VkCommandPool m_uploadCommandPool = VK_NULL_HANDLE;  // Upload batches (game thread)
     std::vector<VkCommandBuffer> m_commandBuffers;
 
+    // Headless rendering: one offscreen colour target per frame in flight stands in for the swapchain
+    // images, and captured frames are copied into a host-visible readback buffer
+    bool m_headless = false;
+    std::vector<DeviceAllocation> m_offscreenImageMemory;
+    std::map<uint64_t, std::string> m_frameCaptures; // Frame number -> PPM path
+    VkBuffer m_captureBuffer = VK_NULL_HANDLE;
+    DeviceAllocation m_captureBufferMemory;
+    void* m_captureBufferMapped = nullptr;
+
+    // Frame graph, declared again every frame by buildFrameGraph. Its only transient so far is the
+    // scene colour target (when the render scale is below 1). Transient images share one heap across
+    // all frames in flight and are only re-created when the graph's memory layout changes.
+    struct TransientImage {
+        std::string name;
+        VkExtent2D extent{};
+        VkImageUsageFlags usage = 0;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;  // With m_renderPass, when a colour attachment
+        VkMemoryRequirements requirements{};
+        VkDeviceSize boundOffset = UINT64_MAX;       // Where the image is bound in m_transientHeap
+        int resource = -1;                           // In this frame's graph
+    };
+    FrameGraph m_frameGraph;
+    std::vector<VkImage> m_frameGraphImages;         // By graph resource, for this frame's barriers
+    float m_renderScale = 1.0f;
+    VkExtent2D m_sceneExtent{};                      // World passes render at this size
+    std::vector<TransientImage> m_transientImages;
+    DeviceAllocation m_transientHeap;
+    std::string m_frameGraphSummary;                 // Logged whenever it changes
+
     // Synchronization objects
     std::vector<VkSemaphore> m_imageAvailableSemaphores;
     std::vector<VkSemaphore> m_renderFinishedSemaphores;
@@ -156,32 +492,349 @@ private:
     // Multiple texture support
     struct Texture {
         VkImage image;
-        VkDeviceMemory memory;
+        DeviceAllocation memory;
         VkImageView view;
         int width;
         int height;
+        uint32_t mipLevels = 1;
+        TextureFilter filter = TextureFilter::Linear; // Picks the sampler in the bindless slot
     };
     
     std::vector<Texture> m_textures;
+
+    // Logical texture handles (returned by loadTexture) map to a physical texture plus UV rect,
+    // so several handles can share one atlas page
+    struct TextureRegion {
+        int textureIndex;
+        float uvRect[4];
+        bool ready = true; // False while an atlas batch or async load is still pending
+        int refCount = 1;
+        std::string cacheKey; // Empty for uncached regions (default texture)
+        uint64_t revision = 0; // m_textureRegionRevision when textureIndex or uvRect last changed
+    };
+    std::vector<TextureRegion> m_textureRegions;
+    std::vector<int> m_freeTextureRegions; // Released handles, reused by registerTextureRegion
+
+    // Texture cache and lifetime. Physical textures are refcounted by the handles pointing at them;
+    // freed ones are destroyed a few frames later and their bindless slot is reused.
+    std::unordered_map<std::string, int> m_textureCache; // Cache key -> handle
+    std::vector<int> m_textureRefCounts;                 // Live handles per physical texture
+    std::vector<uint32_t> m_freeTextureSlots;
+    struct DeferredTextureDeletion {
+        int textureIndex;
+        uint64_t frameNumber;      // Frame during which the last handle was released
+        uint64_t uploadBatchCount; // Upload batches submitted by then (may still write the image)
+    };
+    std::vector<DeferredTextureDeletion> m_deferredTextureDeletions;
+    bool m_defragmentPending = false; // Set when released textures were freed
+    uint64_t m_frameNumber = 0;       // Frame being queued by the game thread
+    uint64_t m_submittedUploadBatchCount = 0;
+    uint64_t m_retiredUploadBatchCount = 0;
+
+    // Pending atlas batch
+    struct PendingAtlasEntry {
+        int handle;
+        ImageData image;
+        std::string path; // Set by loadTextureAsync; decoded when the batch is built
+    };
+    static const int ATLAS_MAX_PAGE_SIZE = 4096;
+    static const int ATLAS_PADDING = 4;
+    static const uint32_t ATLAS_MIP_LEVELS = 3; // Levels whose box filter stays inside the padding (2^(n-1) <= padding)
+    bool m_atlasBatchActive = false;
+    int m_atlasMaxEntrySize = 0;
+    std::vector<PendingAtlasEntry> m_pendingAtlasEntries;
+    uint32_t m_maxImageDimension2D = ATLAS_MAX_PAGE_SIZE;
+
+    // Texture streaming. Workers decode files (and compose atlas pages) into m_decodedImages;
+    // the render thread turns them into uploads and retires each one when its fence signals.
+    struct StreamedRegion {
+        int handle;
+        float uvRect[4];
+    };
+    struct StreamedImage {
+        ImageData image;                     // Empty if decoding failed or a cooked file is used
+        std::shared_ptr<CookedTextureFile> cooked; // Mapped container, uploaded with its whole mip chain
+        TextureFilter filter = TextureFilter::Linear;
+        uint32_t maxMipLevels = 0;           // 0 = full chain
+        std::vector<StreamedRegion> regions; // Handles to point at the uploaded texture
+    };
+    struct TextureLevel {
+        VkDeviceSize offset; // Into the pixel data passed to uploadTextureLevels
+        int width;
+        int height;
+    };
+    struct StreamedTexture {
+        Texture texture;
+        std::vector<StreamedRegion> regions;
+    };
+    static const VkDeviceSize STREAMING_UPLOAD_BUDGET = 16 * 1024 * 1024; // Bytes of new uploads started per frame
+    std::unique_ptr<ThreadPool> m_streamingPool;
+    std::mutex m_streamingMutex; // Guards m_decodedImages
+    std::vector<StreamedImage> m_decodedImages;
+    size_t m_streamedTexturesInFlight = 0; // Streamed textures recorded but not yet published
+
+    // Upload batches
+    struct UploadBatch {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkDeviceSize stagingBytes = 0;             // Ring bytes consumed, including alignment and wrap
+        std::vector<VkBuffer> dedicatedBuffers;    // Uploads too large for the ring
+        std::vector<DeviceAllocation> dedicatedMemory;
+        std::vector<StreamedTexture> streamedTextures; // Published when the fence signals
+    };
+    static const VkDeviceSize STAGING_RING_SIZE = 32 * 1024 * 1024;
+    static const VkDeviceSize STAGING_ALIGNMENT = 16;
+    VkBuffer m_stagingRingBuffer = VK_NULL_HANDLE;
+    DeviceAllocation m_stagingRingMemory;
+    uint8_t* m_stagingRingMapped = nullptr;
+    VkDeviceSize m_stagingRingHead = 0;  // Next free byte
+    VkDeviceSize m_stagingRingUsed = 0;  // Bytes owned by the open and submitted batches
+    int m_uploadBatchDepth = 0;
+    UploadBatch m_openUpload;            // Recording; commandBuffer is null until the first upload
+    std::deque<UploadBatch> m_submittedUploads; // In submission order
     VkSampler m_textureSampler;
+    VkSampler m_nearestSampler = VK_NULL_HANDLE; // Pixel-art textures (TextureFilter::Nearest)
+    bool m_blitMipmapsSupported = false;         // Texture format supports linear blits; else mips are built on the CPU
     int m_currentTextureIndex = 0; // Default texture index
     VkBuffer m_vertexBuffer;
-    VkDeviceMemory m_vertexBufferMemory;
+    DeviceAllocation m_vertexBufferMemory;
     VkBuffer m_indexBuffer;
-    VkDeviceMemory m_indexBufferMemory;
-    std::vector<VkBuffer> m_uniformBuffers;
-    std::vector<VkDeviceMemory> m_uniformBuffersMemory;
-    VkDescriptorSetLayout m_descriptorSetLayout;
+    DeviceAllocation m_indexBufferMemory;
+    VkDescriptorSetLayout m_descriptorSetLayout;  // Set 0: frame uniforms (dynamic offset into the frame ring), animation table, lights
     VkDescriptorPool m_descriptorPool;
-    std::vector<VkDescriptorSet> m_descriptorSets;
-    std::vector<VkDescriptorSet> m_textureDescriptorSets; // Separate descriptor sets for each texture
+    VkDescriptorSet m_frameDescriptorSet = VK_NULL_HANDLE;
+
+    // Set 1: one global sampler2D array indexed per sprite (descriptor indexing, update-after-bind)
+    static const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+    uint32_t m_maxBindlessTextures = MAX_BINDLESS_TEXTURES;
+    bool m_useDescriptorIndexingExtension = false; // Pre-1.2 devices expose it as VK_EXT_descriptor_indexing
+    VkDescriptorSetLayout m_bindlessSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_bindlessDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_bindlessDescriptorSet = VK_NULL_HANDLE;
     VkPipelineLayout m_pipelineLayout;
     VkPipeline m_graphicsPipeline;
+
+    // Pipeline cache shared by every pipeline, persisted per user between runs. The file carries a
+    // PipelineCacheFileHeader so data from another device or driver version is never handed to the driver.
+    struct PipelineCacheFileHeader {
+        char magic[4];              // "CRPC"
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+        uint64_t dataHash;          // FNV-1a of the cache data
+    };
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    std::string m_pipelineCachePath;
+    bool m_pipelineCacheLoaded = false;  // Started from a valid file (warm start)
+
+    // Startup measurement
+    std::chrono::steady_clock::time_point m_initializeStartTime;
+    double m_startupToFirstFrameMs = 0.0;
   // Remember where assets were found so others can reference
   std::string m_assetsBasePath;
-    int m_spritesToRender;
-    static const int MAX_SPRITES = 1000; // Maximum number of sprites per frame
-    std::vector<SpriteTransform> m_spriteTransforms; // Store transform data for each sprite
+    static const size_t INITIAL_SPRITE_CAPACITY = 1024;
+
+    // Render thread. The game thread queues each frame into a FramePacket; render() publishes it and
+    // the render thread records, submits and presents it while the game fills the other packet. A
+    // published packet belongs to the render thread until it is done with it (it sorts it in place).
+    // Everything else the render thread touches is either its own (swapchain, frame command buffers,
+    // frame ring, timing slots, transient images) or outlives every frame that can use it: textures
+    // and sprite sets are only created, changed and freed on the game thread, and freed once
+    // m_completedFrameCount shows no frame using them is left.
+    struct SpriteSetDraw {
+        int spriteSet;
+        RenderLayer layer;
+        float cullRect[4];  // minX, minY, maxX, maxY in the layer's units
+        uint32_t count;     // Sprites in the set
+    };
+    struct FramePacket {
+        uint64_t frameNumber = 0;
+        std::vector<SpriteInstance> instances;   // Resolved, in submission order
+        RenderQueue queue;                       // One sort key per instance
+        std::vector<SpriteSetDraw> spriteSets;   // In drawSpriteSet order
+        float view[16];                          // Camera matrices for the world layers
+        float proj[16];
+        float animationTime = 0.0f;
+        uint32_t animationClipCount = 0;         // Clips uploaded when the packet was published
+        bool animated = false;                   // Holds animated sprites, so time alone changes it
+        std::vector<PointLight> lights;          // World units, in addLight order
+        float ambientLight[3] = {1.0f, 1.0f, 1.0f};
+        bool lit = false;                        // Lights queued or ambient other than white
+        bool hasInputSample = false;             // Latency probe
+        std::chrono::steady_clock::time_point inputTime;
+    };
+    FramePacket m_framePackets[2];
+    int m_buildPacket = 0;                       // Being queued by the game thread
+    std::mutex m_packetMutex;                    // Guards the two below and m_stopRenderThread
+    std::condition_variable m_packetCondition;
+    int m_pendingPacket = -1;                    // Published, not yet taken by the render thread
+    int m_drawingPacket = -1;                    // Being drawn by the render thread
+    bool m_stopRenderThread = false;
+    std::thread m_renderThread;
+    std::mutex m_queueMutex;                     // m_graphicsQueue is submitted to from both threads
+    std::atomic<uint64_t> m_completedFrameCount{0};  // Every frame numbered below this has finished on the GPU
+    std::vector<uint64_t> m_slotFrameNumbers;    // Frame last submitted with each in-flight fence
+    double m_lastHandoffWaitMs = 0.0;
+    // Reactive rendering: hash of the last packet handed to the render thread
+    bool m_reactiveRendering = false;
+    bool m_frameSkipped = false;
+    uint64_t m_skippedFrameCount = 0;
+    uint64_t m_lastPacketHash = 0;
+    bool m_lastPacketHashValid = false;
+    std::atomic<bool> m_redrawRequested{false};  // Window damage, a new sprite set or a dropped present
+    std::vector<SpriteInstance> m_sortedInstances; // Render thread scratch for sortQueuedSprites
+    RenderLayer m_currentLayer = RenderLayer::Background;
+    Camera2D m_camera;
+
+    // GPU-culled sprite sets. Slots are fixed so their descriptor sets (one per frame in flight)
+    // are written once per use; a destroyed set's slot is reused once no frame can still read it.
+    enum class SpriteSetState { Free, Live, Retiring };
+    struct SpriteSet {
+        SpriteSetState state = SpriteSetState::Free;
+        std::vector<SpriteInstance> sprites;       // As given, with texture handles unresolved
+        bool animated = false;                     // Some sprites are SPRITE_ANIMATED_FLAG
+        std::vector<int> handles;                  // Distinct texture handles the sprites use
+        uint64_t resolvedRevision = 0;             // m_textureRegionRevision of the uploaded copy
+        uint64_t retireFrame = 0;                  // Frame and upload batch count at destroySpriteSet
+        uint64_t retireUploadBatchCount = 0;
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;  // Resolved instances (compute input)
+        DeviceAllocation instanceMemory;
+        VkBuffer visibleBuffer = VK_NULL_HANDLE;   // Survivors (compute output, instance vertex buffer), a slice per frame in flight
+        DeviceAllocation visibleMemory;
+        VkBuffer indirectBuffer = VK_NULL_HANDLE;  // One VkDrawIndexedIndirectCommand per frame in flight (aligned slots)
+        DeviceAllocation indirectMemory;
+        VkDeviceSize visibleSliceSize = 0;
+        std::vector<VkDescriptorSet> descriptorSets;
+    };
+    struct CullPushConstants {
+        float cullRect[4];  // minX, minY, maxX, maxY in the layer's units
+        uint32_t count;
+    };
+    static const int MAX_SPRITE_SETS = 16;
+    static const uint32_t CULL_WORKGROUP_SIZE = 64;    // Matches local_size_x in cull.comp
+    static const VkDeviceSize STORAGE_SLICE_ALIGNMENT = 256; // Spec maximum of minStorageBufferOffsetAlignment
+    VkDescriptorSetLayout m_cullDescriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_cullDescriptorPool = VK_NULL_HANDLE;
+    VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+    std::vector<SpriteSet> m_spriteSets;
+
+    // Sprite-sheet animation. The packed clip table (packAnimationTable) lives in a device-local
+    // storage buffer (set 0, binding 1) and is only uploaded again when a clip is added or dropped
+    // or a sheet's region moves, never per frame.
+    static const VkDeviceSize ANIMATION_TABLE_BYTES = 64 * 1024;
+    std::vector<AnimationClip> m_animationClips;
+    VkBuffer m_animationBuffer = VK_NULL_HANDLE;
+    DeviceAllocation m_animationBufferMemory;
+    uint32_t m_uploadedAnimationClipCount = 0;
+    bool m_animationClipsChanged = false;    // A clip was added or dropped since the upload
+    uint64_t m_animationTableRevision = 0;   // m_textureRegionRevision of the uploaded table
+    double m_animationTime = 0.0;
+
+    // Tiled light culling (light_cull.comp). The frame's lights are copied into the frame ring in
+    // scene pixels; the pass writes a count and up to MAX_LIGHTS_PER_TILE light indices per tile into
+    // this frame's slice of m_lightTileBuffer, which the sprite fragment shader reads (set 0,
+    // bindings 2 and 3). The buffer grows with the scene extent, like the frame ring.
+    static const uint32_t LIGHT_TILE_SIZE = 16;            // Pixels, matches light_cull.comp
+    static const uint32_t LIGHT_TILE_WORDS = 32;           // Count, then the light indices
+    static const uint32_t MAX_LIGHTS_PER_TILE = LIGHT_TILE_WORDS - 1;
+    static const uint32_t MAX_LIGHTS = 1024;
+    static const uint32_t LIGHT_CULL_WORKGROUP_SIZE = 64;  // Matches local_size_x in light_cull.comp
+    struct LightCullPushConstants {
+        uint32_t tileCountX;
+        uint32_t tileCountY;
+        uint32_t lightCount;
+        uint32_t padding;
+    };
+    VkDescriptorSetLayout m_lightCullSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool m_lightCullDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_lightCullDescriptorSet = VK_NULL_HANDLE;
+    VkPipelineLayout m_lightCullPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_lightCullPipeline = VK_NULL_HANDLE;
+    VkBuffer m_lightTileBuffer = VK_NULL_HANDLE;
+    DeviceAllocation m_lightTileMemory;
+    VkDeviceSize m_lightTileSliceSize = 0;                 // Per frame in flight
+    uint32_t m_lightTileCountX = 0;                        // Render thread: the scene's tile grid
+    uint32_t m_lightTileCountY = 0;
+    float m_ambientLight[3] = {1.0f, 1.0f, 1.0f};
+    bool m_lightLimitWarned = false;
+    uint64_t m_textureRegionRevision = 1;  // Bumped whenever an existing handle's texture or UVs change
+
+    // Per-frame transient data (uniforms, sprite instances, transient vertices). One persistently
+    // mapped buffer is split into a segment per frame in flight; each frame allocates linearly from
+    // its segment, which is rewound once that frame's fence has signalled. Nothing is mapped,
+    // unmapped or created per frame.
+    struct FrameAllocation {
+        VkBuffer buffer;
+        VkDeviceSize offset; // From the start of buffer (use as a dynamic or binding offset)
+        void* mapped;
+    };
+    static const VkDeviceSize INITIAL_FRAME_RING_SEGMENT_SIZE = 4 * 1024 * 1024;
+    VkBuffer m_frameRingBuffer = VK_NULL_HANDLE;
+    DeviceAllocation m_frameRingMemory;
+    uint8_t* m_frameRingMapped = nullptr;
+    VkDeviceSize m_frameRingSegmentSize = 0;
+    VkDeviceSize m_frameRingOffset = 0;  // Bytes used in the current frame's segment
+    VkDeviceSize m_minUniformBufferOffsetAlignment = 256;
+
+    // GPU timing: one range of timestamp queries per frame in flight, [frame begin, frame end,
+    // layer 0 begin, layer 0 end, ...]. A slot is read back after its fence wait, never stalling.
+    struct FrameTimingSlot {
+        FrameStats stats;           // CPU side filled at submit, GPU side at readback
+        uint32_t queryCount = 0;    // Timestamps written this frame
+        bool pending = false;
+    };
+    static const uint32_t MAX_TIMED_LAYERS = 16;
+    static const uint32_t TIMESTAMPS_PER_FRAME = 2 + 2 * MAX_TIMED_LAYERS;
+    VkQueryPool m_timestampQueryPool = VK_NULL_HANDLE;
+    float m_timestampPeriod = 0.0f;     // Nanoseconds per tick
+    uint64_t m_timestampMask = 0;       // Valid bits of the graphics queue's timestamps
+    std::vector<FrameTimingSlot> m_frameTimingSlots;
+    FrameStats m_frameStats;
+    mutable std::mutex m_frameStatsMutex;  // m_frameStats is written by the render thread
+
+    // Sprite recording: the sorted sprites are cut into layers (render layers, and chunks of large
+    // layers), each recorded into a secondary command buffer that the primary executes. Big frames
+    // are recorded on m_recordingPool workers, each worker using its own RecordingContext (command
+    // pool) so no pool is shared between threads; small frames record on the calling thread.
+    struct RecordingContext {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> commandBuffers;  // Secondaries, recycled by resetting the pool
+        size_t usedCount = 0;
+    };
+    struct SpriteLayer {
+        uint32_t firstSprite;
+        uint32_t spriteCount;
+        const char* label;          // Render layer name
+        RenderLayer renderLayer;
+        uint32_t beginQuery;        // Timestamp indices, UINT32_MAX when untimed
+        uint32_t endQuery;
+        VkCommandBuffer commandBuffer;
+        int spriteSet = -1;         // GPU-culled set drawn indirectly instead of queued sprites
+    };
+    struct SpriteRecordState {
+        VkCommandBufferInheritanceInfo inheritance;
+        FrameAllocation instances;
+        uint32_t cameraUniformOffset;   // Frame uniforms for renderLayerUsesCamera layers
+        uint32_t screenUniformOffset;   // Identity matrices: the layer is already in NDC
+        uint32_t lightOffset;           // This frame's lights in the frame ring
+        uint32_t lightCount;            // Lights binned into the tile lists (0: ambient only)
+        const FramePacket* packet;
+    };
+    static const uint32_t SPRITE_LAYER_CHUNK = 16384;             // Sprites per secondary at most
+    static const uint32_t PARALLEL_RECORDING_MIN_SPRITES = 8192;  // Below this, workers cost more than they save
+    static const size_t MAX_RECORDING_THREADS = 4;
+    std::unique_ptr<ThreadPool> m_recordingPool;
+    std::vector<std::vector<RecordingContext>> m_recordingContexts;  // [frame in flight][context]
+    std::vector<SpriteLayer> m_spriteLayers;
+
+    // VK_EXT_debug_utils labels (loaded when the instance extension is enabled)
+    bool m_debugUtilsEnabled = false;
+    PFN_vkCmdBeginDebugUtilsLabelEXT m_vkCmdBeginDebugUtilsLabelEXT = nullptr;
+    PFN_vkCmdEndDebugUtilsLabelEXT m_vkCmdEndDebugUtilsLabelEXT = nullptr;
 
     // Private methods
     bool createWindow();
@@ -190,36 +843,112 @@ private:
     bool createLogicalDevice();
     bool createSurface();
     bool createSwapChain();
+    bool createOffscreenTargets();
+    bool recordFrameCapture(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    bool writeFrameCapture(uint64_t frameNumber, const std::string& path);
     bool createImageViews();
     bool createRenderPass();
     bool createFramebuffers();
+    void chooseSceneExtent();
+    void buildFrameGraph(VkCommandBuffer commandBuffer, uint32_t imageIndex, size_t uiLayerBegin, uint64_t frameNumber);
+    int declareTransientImage(const std::string& name, VkExtent2D extent, VkImageUsageFlags usage);
+    void resetTransientImage(TransientImage& transient);
+    void bindTransientImages();
+    void destroyTransientImages();
+    void emitFrameGraphBarriers(VkCommandBuffer commandBuffer, const std::vector<FrameGraph::Barrier>& barriers);
+    // Runs sprite layers [firstLayer, endLayer) in one render pass instance
+    void recordSpritePass(VkCommandBuffer commandBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent,
+                          size_t firstLayer, size_t endLayer);
     bool createCommandPool();
     bool createCommandBuffers();
     bool createSyncObjects();
     bool createTextureImage(const std::string& path);
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-    VkImageView createImageView(VkImage image, VkFormat format);
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+    int createTextureFromPixels(const uint8_t* pixels, int width, int height, TextureFilter filter = TextureFilter::Linear, uint32_t maxMipLevels = 0);
+    int registerTextureRegion(int textureIndex, float u0, float v0, float u1, float v1);
+    int addTexture(const Texture& texture);
+    size_t getLiveTextureCount() const { return m_textures.size() - m_freeTextureSlots.size(); }
+    std::string makeTextureCacheKey(const std::string& path, TextureFilter filter) const;
+    int acquireCachedTexture(const std::string& cacheKey);
+    int cacheTextureHandle(int handle, const std::string& cacheKey);
+    void scheduleTextureDeletion(int textureIndex);
+    void processDeferredTextureDeletions();
+    int createTextureFromCooked(const CookedTextureFile& cooked, uint32_t baseLevel, TextureFilter filter);
+    Texture uploadTexturePixels(const uint8_t* pixels, int width, int height, TextureFilter filter = TextureFilter::Linear, uint32_t maxMipLevels = 0);
+    Texture uploadTextureLevels(const uint8_t* data, VkDeviceSize size, const std::vector<TextureLevel>& levels, uint32_t mipLevels = 0);
+    Texture uploadCookedTexture(const CookedTextureFile& cooked, uint32_t baseLevel);
+    void generateMipmaps(VkCommandBuffer commandBuffer, VkImage image, int width, int height, uint32_t mipLevels);
+    static bool decodeTextureFile(const std::string& path, int maxSize, ImageData& out);
+    void applyStreamedRegions(int textureIndex, const std::vector<StreamedRegion>& regions);
+    void pollTextureStreaming();
+    static std::vector<StreamedImage> buildAtlasPages(std::vector<PendingAtlasEntry>& entries, int pageLimit, int maxEntrySize);
+    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, DeviceAllocation& imageMemory, uint32_t mipLevels = 1);
+    VkImageView createImageView(VkImage image, VkFormat format, uint32_t mipLevels = 1);
+    void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
     void createTextureSampler();
     void createVertexBuffer();
     void createIndexBuffer();
     void createDescriptorSetLayout();
     void createDescriptorPool();
     void createDescriptorSets();
-    void createTextureDescriptorSets();
-    void createUniformBuffers();
+    void writeBindlessTexture(uint32_t textureIndex);
+    void createTimestampQueries();
+    void readFrameTimings(size_t slot);
+    void createRecordingContexts();
+    void destroyRecordingContexts();
+    uint64_t makeSpriteKey(const SpriteInstance& resolved) const;
+    bool createCullPipeline();
+    void destroyCullPipeline();
+    void uploadSpriteSet(SpriteSet& set);
+    void destroySpriteSetBuffers(SpriteSet& set);
+    void processRetiredSpriteSets();
+    // Resets and fills the indirect draws of this frame's sprite sets (before the render pass)
+    void recordSpriteSetCulling(VkCommandBuffer commandBuffer, const FramePacket& packet);
+    bool createLightCullPipeline();
+    void destroyLightCullPipeline();
+    void createLightTileBuffer(VkDeviceSize sliceSize);
+    void destroyLightTileBuffer();
+    // Sizes the tile grid to the scene extent; called once the frame's fence has signalled
+    void prepareLightTiles();
+    // Copies the packet's lights into the frame ring and bins them into this frame's tile lists
+    void recordLightCulling(VkCommandBuffer commandBuffer, const FramePacket& packet, SpriteRecordState& state);
+    // Sorts the packet's sprites by their render queue keys (its instances end up in draw order)
+    void sortQueuedSprites(FramePacket& packet);
+    void buildSpriteLayers(const FramePacket& packet, uint32_t& queryCount);
+    void recordSpriteLayers(const SpriteRecordState& state);
+    void recordSpriteLayer(RecordingContext& context, SpriteLayer& layer, const SpriteRecordState& state);
+    void beginDebugLabel(VkCommandBuffer commandBuffer, const char* label);
+    void endDebugLabel(VkCommandBuffer commandBuffer);
+    void createFrameRing(VkDeviceSize segmentSize);
+    void destroyFrameRing();
+    void writeFrameDescriptor();
+    void beginFrameData(VkDeviceSize requiredBytes);
+    FrameAllocation allocateFrameData(VkDeviceSize size, VkDeviceSize alignment);
     std::vector<char> readFile(const std::string& filename);
     VkShaderModule createShaderModule(const std::vector<char>& code);
-    void updateUniformBuffer(uint32_t currentImage);
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+    // lighting is the frame's culled lights for lit layers, null for unlit ones
+    uint32_t updateUniformBuffer(const float view[16], const float proj[16], const FramePacket& packet, const SpriteRecordState* lighting);
+    void createAnimationBuffer();
+    void uploadAnimationTable();
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, DeviceAllocation& bufferMemory);
+    void uploadBufferData(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+    void copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize bufferOffset, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevel = 0);
     VkCommandBuffer beginSingleTimeCommands();
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+    void createStagingRing();
+    UploadBatch& getOpenUploadBatch();
+    void stageUploadData(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+    void submitUploadBatch();
+    void retireUploadBatches();
     bool createGraphicsPipeline();
-    bool drawFrame();
-    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+    void createPipelineCache();
+    void savePipelineCache();
+    void publishFramePacket();
+    uint64_t hashFramePacket(const FramePacket& packet) const;
+    void renderThreadMain();
+    void stopRenderThread();
+    // Idles the device; the queue lock is held since other threads may be submitting
+    void waitDeviceIdle();
+    bool drawFrame(FramePacket& packet);
+    void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, FramePacket& packet);
     void renderColoredRect(VkCommandBuffer commandBuffer, float x, float y, float width, float height, float r, float g, float b);
 
     // Helper methods
@@ -228,6 +957,8 @@ private:
     bool isDeviceSuitable(VkPhysicalDevice device);
     uint32_t findQueueFamilies(VkPhysicalDevice device);
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool checkDescriptorIndexingSupport(VkPhysicalDevice device, bool& needsExtension);
+    bool checkPresentWaitSupport(VkPhysicalDevice device);
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
     VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
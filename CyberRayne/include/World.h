@@ -3,10 +3,13 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <cstdint>
 
 class Map;
 class Player;
 class VulkanRenderer;
+struct SpriteInstance;
+struct AnimationPlayback;
 
 class World {
 public:
@@ -24,6 +27,7 @@ public:
 
     bool initialize();
     void loadMapTextures(VulkanRenderer* renderer);
+    void releaseMapTextures(VulkanRenderer* renderer);
     void update(float deltaTime);
     void render(VulkanRenderer* renderer);
     void spawnEnemies();
@@ -50,9 +54,18 @@ private:
     void createMaps();
     void initializeBiomes();
     void spawnEnemiesForBiome(BiomeType biome, Map* map);
+    // Re-uploads the current map's tiles as a GPU-culled sprite set
+    void rebuildSpriteSets(VulkanRenderer* renderer);
+    void destroySpriteSets(VulkanRenderer* renderer);
+    static SpriteInstance entitySprite(float x, float y, const AnimationPlayback& animation, int fallbackTexture);
 
     std::vector<std::unique_ptr<Map>> m_maps;
     Map* m_currentMap;
     BiomeType m_currentBiome;
     Player* m_player;
+
+    // GPU-culled tile set of m_spriteSetMap at m_spriteSetRevision (-1: none, draw on the CPU path)
+    int m_tileSpriteSet = -1;
+    const Map* m_spriteSetMap = nullptr;
+    uint64_t m_spriteSetRevision = 0;
 };
@@ -1,11 +1,80 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) in vec4 fragTint;
+layout(location = 2) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Bindless texture array (set 1), indexed per sprite instance
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+// Frame uniforms (set 0), only the lighting part is used here
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    float time;
+    uint animationClipCount;
+    uint lit;
+    uint lightCount;
+    vec4 ambient;
+    uint lightTileCountX;
+} ubo;
+
+// The frame's point lights in scene pixels and their per-tile lists (light_cull.comp)
+struct Light {
+    vec2 position;
+    float radius;
+    float intensity;
+    vec4 color;
+};
+layout(std430, set = 0, binding = 2) readonly buffer Lights { Light lights[]; };
+layout(std430, set = 0, binding = 3) readonly buffer Tiles { uint tileWords[]; };
+
+// Match LIGHT_TILE_SIZE and LIGHT_TILE_WORDS in VulkanRenderer.h
+const uint LIGHT_TILE_SIZE = 16;
+const uint LIGHT_TILE_WORDS = 32;
+
+// Matches SPRITE_DISTANCE_FIELD_FLAG in VulkanRenderer.h
+const uint DISTANCE_FIELD_FLAG = 0x40000000u;
+
+// Ambient plus the lights binned into this pixel's tile: the cost is bounded by the tile's list,
+// however many lights the frame has
+vec3 lighting() {
+    vec3 light = ubo.ambient.rgb;
+    if (ubo.lightCount == 0u) {
+        return light;
+    }
+    uvec2 tile = uvec2(gl_FragCoord.xy) / LIGHT_TILE_SIZE;
+    uint base = (tile.y * ubo.lightTileCountX + tile.x) * LIGHT_TILE_WORDS;
+    uint count = tileWords[base];
+    for (uint i = 0u; i < count; ++i) {
+        Light point = lights[tileWords[base + 1u + i]];
+        float falloff = clamp(1.0 - distance(gl_FragCoord.xy, point.position) / point.radius, 0.0, 1.0);
+        light += point.color.rgb * point.intensity * falloff * falloff;
+    }
+    return light;
+}
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    // Textures hold premultiplied alpha, so the tint is premultiplied too before modulating
+    vec4 tint = vec4(fragTint.rgb * fragTint.a, fragTint.a);
+    uint textureIndex = fragTextureIndex & ~DISTANCE_FIELD_FLAG;
+    vec4 texel = texture(textures[nonuniformEXT(textureIndex)], fragTexCoord);
+
+    if ((fragTextureIndex & DISTANCE_FIELD_FLAG) != 0u) {
+        // Glyph: alpha is the distance to the outline (0.5 on it). Smooth over about one screen
+        // pixel, whatever the text size. The flag is per instance, so the derivatives are well defined.
+        float distance = texel.a;
+        float width = max(fwidth(distance), 1e-4) * 0.5;
+        outColor = tint * smoothstep(0.5 - width, 0.5 + width, distance);
+        return;
+    }
+    outColor = texel * tint;
+    if (ubo.lit != 0u) {
+        // Premultiplied alpha: scaling the colour alone keeps coverage as it was
+        outColor.rgb *= lighting();
+    }
 }
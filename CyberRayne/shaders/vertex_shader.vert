@@ -1,23 +1,82 @@
 #version 450
 
+// Per-vertex unit quad (binding 0)
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 
+// Per-instance sprite data (binding 1)
+layout(location = 2) in vec2 instPosition;
+layout(location = 3) in vec2 instSize;
+layout(location = 4) in vec4 instUvRect;
+layout(location = 5) in vec4 instTint;
+layout(location = 6) in uint instTextureIndex;
+
+// Frame uniforms (set 0): the camera on world layers, identity on NDC layers
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    float time;
+    uint animationClipCount;
+} ubo;
+
+// Sprite-sheet clips, packed by packAnimationTable (SpriteAnimation.h): a header per clip
+// (first frame, frame count, loop mode, duration bits), then two vec4s per frame (UV rect, end time)
+layout(set = 0, binding = 1) readonly buffer AnimationTable {
+    vec4 words[];
+} animation;
+
+// Matches SPRITE_ANIMATED_FLAG in VulkanRenderer.h
+const uint ANIMATED_FLAG = 0x20000000u;
+const uint LOOP_REPEAT = 1u;
+const uint LOOP_PING_PONG = 2u;
+
 layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) out vec4 fragTint;
+layout(location = 2) flat out uint fragTextureIndex;
 
-// Push constants for per-sprite transform
-layout(push_constant) uniform PushConstants {
-    float x;
-    float y;
-    float width;
-    float height;
-} sprite;
+// Modelled on the CPU by selectPackedAnimationFrame (SpriteAnimation.cpp); change both together
+vec4 animatedUvRect(uint clip, float startTime, float rate) {
+    if (clip >= ubo.animationClipCount) {
+        return vec4(0.0, 0.0, 1.0, 1.0);
+    }
+    uvec4 header = floatBitsToUint(animation.words[clip]);
+    float duration = uintBitsToFloat(header.w);
+    if (header.y == 0u || duration <= 0.0) {
+        return vec4(0.0, 0.0, 1.0, 1.0);
+    }
+
+    float t = max((ubo.time - startTime) * rate, 0.0);
+    if (header.z == LOOP_REPEAT) {
+        t = t - duration * floor(t / duration);
+    } else if (header.z == LOOP_PING_PONG) {
+        t = t - 2.0 * duration * floor(t / (2.0 * duration));
+        t = t > duration ? 2.0 * duration - t : t;
+    }
+
+    uint frame = header.y - 1u;
+    for (uint i = 0u; i < header.y; ++i) {
+        if (t < animation.words[header.x + i * 2u + 1u].x) {
+            frame = i;
+            break;
+        }
+    }
+    return animation.words[header.x + frame * 2u];
+}
 
 void main() {
     // Scale the unit quad (-0.5 to 0.5) by sprite dimensions and translate
-    vec2 scaledPos = inPosition * vec2(sprite.width, sprite.height);
-    vec2 finalPos = scaledPos + vec2(sprite.x, sprite.y);
+    vec2 scaledPos = inPosition * instSize;
+    vec2 finalPos = scaledPos + instPosition;
     
-    gl_Position = vec4(finalPos, 0.0, 1.0);
-    fragTexCoord = inTexCoord;
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(finalPos, 0.0, 1.0);
+    // Map the quad's 0..1 UVs into the sprite's UV sub-rectangle; animated sprites carry their clip
+    // (id, start time, rate) there instead and get the rect of the clip's current frame
+    vec4 uvRect = instUvRect;
+    if ((instTextureIndex & ANIMATED_FLAG) != 0u) {
+        uvRect = animatedUvRect(uint(instUvRect.x), instUvRect.y, instUvRect.z);
+    }
+    fragTexCoord = mix(uvRect.xy, uvRect.zw, inTexCoord);
+    fragTint = instTint;
+    fragTextureIndex = instTextureIndex & ~ANIMATED_FLAG;
 }
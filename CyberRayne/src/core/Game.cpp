@@ -9,6 +9,9 @@
 #endif
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
 
 Game::Game() : m_gameState(nullptr), m_renderer(nullptr), m_running(false),
                m_benchmarkMode(false), m_maxBenchmarkFrames(500), m_benchmarkFrameCount(0) {}
@@ -30,6 +33,22 @@ bool Game::initialize() {
     // Initialize Vulkan renderer
     m_renderer = std::make_unique<VulkanRenderer>();
     std::cout << "Vulkan renderer created." << std::endl;
+    m_renderer->setHeadless(m_headless);
+    if (!m_presentMode.empty()) {
+        VkPresentModeKHR presentMode;
+        if (VulkanRenderer::parsePresentMode(m_presentMode, presentMode)) {
+            m_renderer->setPresentMode(presentMode);
+        } else {
+            std::cerr << "Unknown present mode '" << m_presentMode << "', using the default" << std::endl;
+        }
+    }
+    if (m_framesInFlight > 0) {
+        m_renderer->setFramesInFlight(static_cast<uint32_t>(m_framesInFlight));
+    }
+    m_renderer->setRenderScale(m_renderScale);
+    for (const auto& capture : m_frameCaptures) {
+        m_renderer->requestFrameCapture(static_cast<uint64_t>(capture.first), capture.second);
+    }
     if (!m_renderer->initialize(1920, 1080, "Cyber Rayne")) {
         std::cerr << "Failed to initialize Vulkan renderer!" << std::endl;
         return false;
@@ -60,7 +79,8 @@ void Game::run() {
     
     // Simple game loop
     const int targetFPS = 60;
-    const std::chrono::milliseconds frameDelay(1000 / targetFPS);
+    const double IDLE_WAIT_SECONDS = 0.1;
+    const std::chrono::microseconds frameDelay(m_frameRateCap > 0 ? 1000000 / m_frameRateCap : 0);
     
     auto lastTime = std::chrono::high_resolution_clock::now();
     
@@ -70,6 +90,10 @@ void Game::run() {
         auto currentTime = std::chrono::high_resolution_clock::now();
         float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
         lastTime = currentTime;
+        if (m_headless) {
+            // Fixed step: headless frames must not depend on how fast the device renders
+            deltaTime = 1.0f / targetFPS;
+        }
 
         // Log frame rate every 60 frames to avoid spam
         static int frameCount = 0;
@@ -78,49 +102,66 @@ void Game::run() {
             std::cout << "[DEBUG] Frame " << frameCount << " - DeltaTime: " << deltaTime << "s (FPS: " << (1.0f / deltaTime) << ")" << std::endl;
         }
         
-        // Handle input
+        // Handle input (the latency probe starts here)
+        if (m_renderer) {
+            m_renderer->markInputSampled();
+        }
+        bool inputActive = false;
         if (m_gameState) {
 #ifdef _WIN32
             if (GetAsyncKeyState(VK_UP) & 0x8000) {
+                inputActive = true;
                 m_gameState->handleInput(0);
             }
             if (GetAsyncKeyState(VK_DOWN) & 0x8000) {
+                inputActive = true;
                 m_gameState->handleInput(1);
             }
             if (GetAsyncKeyState(VK_RETURN) & 0x8000) {
                 std::cout << "[DEBUG] Enter key pressed - handling input 2" << std::endl;
+                inputActive = true;
                 m_gameState->handleInput(2);
             }
             if (GetAsyncKeyState(VK_LEFT) & 0x8000) {
+                inputActive = true;
                 m_gameState->handleInput(3);
             }
             if (GetAsyncKeyState(VK_RIGHT) & 0x8000) {
+                inputActive = true;
                 m_gameState->handleInput(4);
             }
 #else
             GLFWwindow* window = m_renderer ? m_renderer->getWindow() : nullptr;
             if (window) {
                 if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
+                    inputActive = true;
                     m_gameState->handleInput(0);
                 }
                 if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
+                    inputActive = true;
                     m_gameState->handleInput(1);
                 }
                 if (glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS) {
                     std::cout << "[DEBUG] Enter key pressed - handling input 2" << std::endl;
+                    inputActive = true;
                     m_gameState->handleInput(2);
                 }
                 if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
+                    inputActive = true;
                     m_gameState->handleInput(3);
                 }
                 if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
+                    inputActive = true;
                     m_gameState->handleInput(4);
                 }
             }
 #endif
         }
 
-        // Update game state
+        // Update game state; animated sprites run on the same clock
+        if (m_renderer) {
+            m_renderer->advanceAnimationTime(deltaTime);
+        }
         if (m_gameState) {
             m_gameState->update(deltaTime);
         }
@@ -130,8 +171,13 @@ void Game::run() {
             m_gameState->render(m_renderer.get());
         }
         
-        // Render with Vulkan
+        // Render with Vulkan. Static screens only redraw when what they queue changes.
         if (m_renderer) {
+            if (m_gameState) {
+                const GameState::State state = m_gameState->getCurrentState();
+                m_renderer->setReactiveRendering(m_reactiveRendering && !m_benchmarkMode && !m_headless &&
+                                                 (state == GameState::State::MENU || state == GameState::State::CHARACTER_SELECTION));
+            }
             m_renderer->render();
         }
         
@@ -147,6 +193,7 @@ void Game::run() {
         
         // Benchmark mode: exit after max frames
         if (m_benchmarkMode) {
+            recordBenchmarkFrame(deltaTime, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - currentTime).count());
             m_benchmarkFrameCount++;
             if (m_benchmarkFrameCount >= m_maxBenchmarkFrames) {
                 std::cout << "Benchmark complete: " << m_benchmarkFrameCount << " frames rendered." << std::endl;
@@ -154,7 +201,18 @@ void Game::run() {
             }
         }
         
-        // Cap frame rate
+        // Nothing changed on screen and no key is held: sleep until a window event (a key press wakes
+        // the loop at once) or the idle timeout, which keeps time-driven state ticking
+        if (m_renderer && m_renderer->wasFrameSkipped() && !inputActive) {
+            m_renderer->waitForEvents(IDLE_WAIT_SECONDS);
+            continue;
+        }
+
+        // Cap frame rate (headless runs as fast as the device allows). Sleeping here delays the next
+        // input sample, so low-latency setups turn the cap off and let the present mode pace frames.
+        if (m_headless || m_frameRateCap <= 0) {
+            continue;
+        }
         auto frameTime = std::chrono::high_resolution_clock::now() - currentTime;
         if (frameTime < frameDelay) {
             std::this_thread::sleep_for(frameDelay - frameTime);
@@ -162,6 +220,100 @@ void Game::run() {
     }
     
     std::cout << "Game loop ended." << std::endl;
+    if (m_renderer) {
+        // The last packet may still be drawing; its stats and latency sample belong in the reports
+        m_renderer->waitForRenderThread();
+        m_renderer->printLatencyReport();
+    }
+    if (m_benchmarkMode) {
+        writeBenchmarkSummary();
+    }
+}
+
+void Game::recordBenchmarkFrame(float frameSeconds, double cpuMs) {
+    // The first loop iteration has no meaningful interval
+    if (m_benchmarkFrameCount > 0) {
+        m_benchmarkSamples.frameMs.push_back(frameSeconds * 1000.0);
+        m_benchmarkSamples.cpuMs.push_back(cpuMs);
+        m_benchmarkSamples.cpuWaitMs.push_back(m_renderer->getLastHandoffWaitMs());
+    }
+
+    const FrameStats stats = m_renderer->getFrameStats();
+    if (stats.frameNumber == m_benchmarkSamples.lastStatsFrame || (stats.frameNumber == 0 && stats.drawCalls == 0 && !stats.gpuTimingValid)) {
+        return;
+    }
+    m_benchmarkSamples.lastStatsFrame = stats.frameNumber;
+    m_benchmarkSamples.drawCalls.push_back(stats.drawCalls);
+    m_benchmarkSamples.sprites.push_back(stats.sprites);
+    if (stats.gpuTimingValid) {
+        m_benchmarkSamples.gpuMs.push_back(stats.gpuFrameMs);
+        for (const GpuPassTiming& pass : stats.passes) {
+            m_benchmarkSamples.passGpuMs[pass.label].push_back(pass.gpuMs);
+        }
+    }
+}
+
+void Game::writeBenchmarkSummary() const {
+    // Same layout the CI report step reads (frame_time.avg_ms, total_frames, draw_calls.avg, ...)
+    auto writeStats = [](std::ofstream& out, const char* name, std::vector<double> samples, bool last) {
+        double sum = 0.0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&](double p) { return samples.empty() ? 0.0 : samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))]; };
+        out << "  \"" << name << "\": {\"avg_ms\": " << (samples.empty() ? 0.0 : sum / samples.size())
+            << ", \"p50_ms\": " << percentile(0.50) << ", \"p95_ms\": " << percentile(0.95)
+            << ", \"p99_ms\": " << percentile(0.99) << ", \"max_ms\": " << (samples.empty() ? 0.0 : samples.back())
+            << ", \"samples\": " << samples.size() << "}" << (last ? "\n" : ",\n");
+    };
+    auto average = [](const std::vector<double>& samples) {
+        double sum = 0.0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        return samples.empty() ? 0.0 : sum / samples.size();
+    };
+
+    const char* outputDir = std::getenv("AUDITOR_OUTPUT_PATH");
+    std::string path = std::string(outputDir && *outputDir ? outputDir : ".") + "/cyberrayne_summary.json";
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write benchmark summary: " << path << std::endl;
+        return;
+    }
+
+    // CPU-bound when the loop's own work (minus time blocked on the GPU) exceeds the GPU frame time
+    double cpuWork = average(m_benchmarkSamples.cpuMs) - average(m_benchmarkSamples.cpuWaitMs);
+    double gpuWork = average(m_benchmarkSamples.gpuMs);
+    const char* bottleneck = m_benchmarkSamples.gpuMs.empty() ? "unknown" : (gpuWork > cpuWork ? "gpu" : "cpu");
+
+    out << "{\n";
+    out << "  \"total_frames\": " << m_benchmarkFrameCount << ",\n";
+    out << "  \"present_mode\": \"" << (m_headless ? "headless" : VulkanRenderer::presentModeName(m_renderer->getPresentMode())) << "\",\n";
+    out << "  \"frames_in_flight\": " << m_renderer->getFramesInFlight() << ",\n";
+    out << "  \"bottleneck\": \"" << bottleneck << "\",\n";
+    out << "  \"startup_to_first_frame_ms\": " << m_renderer->getStartupToFirstFrameMs() << ",\n";
+    DeviceAllocator::Stats memory = m_renderer->getMemoryStats();
+    out << "  \"device_memory\": {\"allocations\": " << memory.allocationCount << ", \"blocks\": " << memory.blockCount
+        << ", \"dedicated\": " << memory.dedicatedCount << ", \"block_kb\": " << memory.blockBytes / 1024
+        << ", \"used_kb\": " << memory.usedBytes / 1024 << ", \"dedicated_kb\": " << memory.dedicatedBytes / 1024 << "},\n";
+    writeStats(out, "frame_time", m_benchmarkSamples.frameMs, false);
+    writeStats(out, "cpu_time", m_benchmarkSamples.cpuMs, false);
+    writeStats(out, "cpu_wait", m_benchmarkSamples.cpuWaitMs, false);
+    writeStats(out, "gpu_time", m_benchmarkSamples.gpuMs, false);
+    out << "  \"gpu_passes\": {";
+    bool first = true;
+    for (const auto& pass : m_benchmarkSamples.passGpuMs) {
+        out << (first ? "" : ", ") << "\"" << pass.first << "\": {\"avg_ms\": " << average(pass.second) << "}";
+        first = false;
+    }
+    out << "},\n";
+    out << "  \"sprites\": {\"avg\": " << average(m_benchmarkSamples.sprites) << "},\n";
+    out << "  \"draw_calls\": {\"avg\": " << average(m_benchmarkSamples.drawCalls) << "}\n";
+    out << "}\n";
+
+    std::cout << "Benchmark summary written to " << path << " (bottleneck: " << bottleneck << ")" << std::endl;
 }
 
 void Game::update(float deltaTime) {
@@ -8,9 +8,22 @@
 #include "../../include/MenuSystem.h"
 #include <iostream>
 
-GameState::GameState() : m_currentState(State::MENU), m_world(nullptr), m_player(nullptr), m_charSelectionSystem(nullptr), m_battleSystem(nullptr), m_menuSystem(nullptr), m_uiManager(nullptr), m_renderer(nullptr) {}
+GameState::GameState() : m_currentState(State::MENU), m_world(nullptr), m_player(nullptr), m_charSelectionSystem(nullptr), m_battleSystem(nullptr), m_menuSystem(nullptr), m_uiManager(nullptr), m_renderer(nullptr) {
+    // 15 tiles high whatever the window size; wider windows see more of the map across
+    m_camera.setViewHeight(15.0f);
+    m_camera.setSmoothing(0.12f);
+}
 
 GameState::~GameState() {
+    // Hand texture references back to the renderer's cache before the owning systems go away
+    if (m_renderer) {
+        if (m_menuSystem) m_menuSystem->releaseTextures(m_renderer);
+        if (m_charSelectionSystem) m_charSelectionSystem->releaseTextures(m_renderer);
+        if (m_uiManager) m_uiManager->releaseTextures(m_renderer);
+        if (m_player) m_player->releaseTexture(m_renderer);
+        if (m_world) m_world->releaseMapTextures(m_renderer);
+    }
+    
     delete m_world;
     delete m_player;
     delete m_charSelectionSystem;
@@ -23,6 +36,11 @@ void GameState::setRenderer(VulkanRenderer* renderer) {
     std::cout << "Setting renderer for GameState" << std::endl;
     m_renderer = renderer;
     
+    // All startup texture loads below go out in one upload submit
+    if (m_renderer) {
+        m_renderer->beginUploadBatch();
+    }
+    
     // Load menu textures if menu system is initialized
     if (m_menuSystem && m_renderer) {
         std::cout << "Loading menu textures" << std::endl;
@@ -48,6 +66,10 @@ void GameState::setRenderer(VulkanRenderer* renderer) {
         std::cout << "Initializing UIManager with renderer" << std::endl;
         m_uiManager->initialize(m_renderer);
     }
+    
+    if (m_renderer) {
+        m_renderer->endUploadBatch();
+    }
 }
 
 bool GameState::initialize() {
@@ -217,10 +239,32 @@ void GameState::update(float deltaTime) {
     // Update player if in world exploration state
     if (m_currentState == State::WORLD_EXPLORATION && m_player) {
         m_player->update(deltaTime);
+        if (m_renderer) {
+            m_player->updateAnimation(m_renderer->getAnimationTime());
+        }
+        updateCamera(deltaTime);
     }
 }
 
+void GameState::updateCamera(float deltaTime) {
+    const Map* map = m_world ? m_world->getCurrentMap() : nullptr;
+    if (!map) {
+        return;
+    }
+    m_camera.setBounds(0.0f, 0.0f, static_cast<float>(map->getWidth()), static_cast<float>(map->getHeight()));
+    // The player's position glides between tiles while moving; aim at the centre of the sprite
+    m_camera.follow(m_player->getX() + 0.5f, m_player->getY() + 0.5f);
+    if (map != m_cameraMap) {
+        m_camera.snapToTarget();
+        m_cameraMap = map;
+    }
+    m_camera.update(deltaTime);
+}
+
 void GameState::render(VulkanRenderer* renderer) {
+    // Layers, not call order, decide what draws on top: tiles are batched by texture, entities are
+    // Y-sorted above them and UI keeps its call order (see RenderQueue.h)
+    renderer->setRenderLayer(m_currentState == State::WORLD_EXPLORATION ? RenderLayer::Tiles : RenderLayer::UI);
     switch (m_currentState) {
         case State::MENU:
             // Render menu
@@ -242,7 +286,8 @@ void GameState::render(VulkanRenderer* renderer) {
             break;
         case State::WORLD_EXPLORATION:
             // Render world exploration
-            // Render world
+            // Render world (the tile and entity layers go through the camera)
+            renderer->setCamera(m_camera);
             if (m_world) {
                 m_world->render(renderer);
             }
@@ -272,40 +317,20 @@ void GameState::render(VulkanRenderer* renderer) {
             renderer->renderSprite(0.0f, 0.0f, 2.0f, 2.0f);
             break;
     }
-    
+
     // Render player if in world exploration state
+    renderer->setRenderLayer(RenderLayer::Entities);
     if (m_currentState == State::WORLD_EXPLORATION && m_player && m_world && m_world->getCurrentMap()) {
-        // Calculate viewport-relative position for player
-        Map* currentMap = m_world->getCurrentMap();
-        const int VIEWPORT_WIDTH = 15;
-        const int VIEWPORT_HEIGHT = 15;
-        int mapWidth = currentMap->getWidth();
-        int mapHeight = currentMap->getHeight();
-        int startX = (mapWidth > VIEWPORT_WIDTH) ? (mapWidth - VIEWPORT_WIDTH) / 2 : 0;
-        int startY = (mapHeight > VIEWPORT_HEIGHT) ? (mapHeight - VIEWPORT_HEIGHT) / 2 : 0;
-        
-        // Calculate tile size (same as in Map::render)
-        float screenAspect = 800.0f / 600.0f;
-        float tileWidth = 2.0f / VIEWPORT_WIDTH;
-        float tileHeight = 2.0f / VIEWPORT_HEIGHT;
-        tileWidth = tileHeight / screenAspect;
-        
-        // Convert player world position to viewport-relative normalized coordinates
-        float playerX = m_player->getX();
-        float playerY = m_player->getY();
-        float normalizedX = -1.0f + (playerX - startX) * tileWidth + tileWidth * 0.5f;
-        float normalizedY = -1.0f + (playerY - startY) * tileHeight + tileHeight * 0.5f;
-        
-        // Render player at viewport-relative position
-        if (m_player->getX() >= startX && m_player->getX() < startX + VIEWPORT_WIDTH &&
-            m_player->getY() >= startY && m_player->getY() < startY + VIEWPORT_HEIGHT) {
-            // Player is within viewport, render using texture
-            int textureIndex = m_player->getTextureIndex();
-            if (textureIndex >= 0) {
-                renderer->renderSpriteWithTexture(normalizedX, normalizedY, tileWidth, tileHeight, textureIndex);
-            } else {
-                renderer->renderSprite(normalizedX, normalizedY, tileWidth, tileHeight);
-            }
+        // One tile in world units; the camera keeps the player on screen
+        const float playerX = m_player->getX() + 0.5f;
+        const float playerY = m_player->getY() + 0.5f;
+        int textureIndex = m_player->getTextureIndex();
+        if (m_player->getAnimation().clip >= 0) {
+            renderer->renderSpriteInstance(SpriteInstance::makeAnimated(playerX, playerY, 1.0f, 1.0f, m_player->getAnimation()));
+        } else if (textureIndex >= 0) {
+            renderer->renderSpriteWithTexture(playerX, playerY, 1.0f, 1.0f, textureIndex);
+        } else {
+            renderer->renderSprite(playerX, playerY, 1.0f, 1.0f);
         }
     }
 }
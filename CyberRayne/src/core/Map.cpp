@@ -9,6 +9,7 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <cmath>
 #include <filesystem>
 
 Map::Map(const std::string& name, int width, int height)
@@ -51,85 +52,107 @@ bool Map::initialize() {
 }
 
 #ifndef NO_VULKAN
+void Map::releaseTileTextures(VulkanRenderer* renderer) {
+    if (!renderer) return;
+    
+    for (const auto& entry : m_tileTextures) {
+        if (entry.second >= 0) {
+            renderer->releaseTexture(entry.second);
+        }
+    }
+    m_tileTextures.clear();
+    ++m_revision;
+}
+
 void Map::loadTileTextures(VulkanRenderer* renderer) {
     if (!renderer) return;
     
+    // Drop references from an earlier load before taking new ones
+    releaseTileTextures(renderer);
+    
     std::string base = renderer->getAssetsBasePath();
     std::string tilesPath = base + "/textures/tiles";
     std::cout << "Loading tile textures from: " << tilesPath << std::endl;
     
+    // Pack all tiles into one atlas page; tiles are drawn at well under 256px on screen.
+    // Loaded asynchronously so entering the world doesn't stall on PNG decoding.
+    renderer->beginTextureAtlas(256);
+    
     // Load proper tile textures from assets/textures/tiles/
     std::string grassPath = tilesPath + "/grass.png";
     if (std::filesystem::exists(grassPath)) {
-        m_tileTextures[Tile::TileType::GRASS] = renderer->loadTexture(grassPath);
-        std::cout << "Loaded GRASS texture: " << m_tileTextures[Tile::TileType::GRASS] << std::endl;
+        m_tileTextures[Tile::TileType::GRASS] = renderer->loadTextureAsync(grassPath);
+        std::cout << "Requested GRASS texture: " << m_tileTextures[Tile::TileType::GRASS] << std::endl;
     } else {
         std::cerr << "GRASS texture not found at: " << grassPath << std::endl;
     }
     
     std::string wallPath = tilesPath + "/wall.png";
     if (std::filesystem::exists(wallPath)) {
-        m_tileTextures[Tile::TileType::WALL] = renderer->loadTexture(wallPath);
-        std::cout << "Loaded WALL texture: " << m_tileTextures[Tile::TileType::WALL] << std::endl;
+        m_tileTextures[Tile::TileType::WALL] = renderer->loadTextureAsync(wallPath);
+        std::cout << "Requested WALL texture: " << m_tileTextures[Tile::TileType::WALL] << std::endl;
     } else {
         std::cerr << "WALL texture not found at: " << wallPath << std::endl;
     }
     
     std::string mountainPath = tilesPath + "/mountain.png";
     if (std::filesystem::exists(mountainPath)) {
-        m_tileTextures[Tile::TileType::MOUNTAIN] = renderer->loadTexture(mountainPath);
-        std::cout << "Loaded MOUNTAIN texture: " << m_tileTextures[Tile::TileType::MOUNTAIN] << std::endl;
+        m_tileTextures[Tile::TileType::MOUNTAIN] = renderer->loadTextureAsync(mountainPath);
+        std::cout << "Requested MOUNTAIN texture: " << m_tileTextures[Tile::TileType::MOUNTAIN] << std::endl;
     } else {
         std::cerr << "MOUNTAIN texture not found at: " << mountainPath << std::endl;
     }
     
     std::string treePath = tilesPath + "/tree.png";
     if (std::filesystem::exists(treePath)) {
-        m_tileTextures[Tile::TileType::TREE] = renderer->loadTexture(treePath);
-        std::cout << "Loaded TREE texture: " << m_tileTextures[Tile::TileType::TREE] << std::endl;
+        m_tileTextures[Tile::TileType::TREE] = renderer->loadTextureAsync(treePath);
+        std::cout << "Requested TREE texture: " << m_tileTextures[Tile::TileType::TREE] << std::endl;
     } else {
         std::cerr << "TREE texture not found at: " << treePath << std::endl;
     }
     
     std::string waterPath = tilesPath + "/water.png";
     if (std::filesystem::exists(waterPath)) {
-        m_tileTextures[Tile::TileType::WATER] = renderer->loadTexture(waterPath);
-        std::cout << "Loaded WATER texture: " << m_tileTextures[Tile::TileType::WATER] << std::endl;
+        m_tileTextures[Tile::TileType::WATER] = renderer->loadTextureAsync(waterPath);
+        std::cout << "Requested WATER texture: " << m_tileTextures[Tile::TileType::WATER] << std::endl;
     } else {
         std::cerr << "WATER texture not found at: " << waterPath << std::endl;
     }
     
     std::string stonePath = tilesPath + "/stone.png";
     if (std::filesystem::exists(stonePath)) {
-        m_tileTextures[Tile::TileType::STONE] = renderer->loadTexture(stonePath);
-        std::cout << "Loaded STONE texture: " << m_tileTextures[Tile::TileType::STONE] << std::endl;
+        m_tileTextures[Tile::TileType::STONE] = renderer->loadTextureAsync(stonePath);
+        std::cout << "Requested STONE texture: " << m_tileTextures[Tile::TileType::STONE] << std::endl;
     } else {
         std::cerr << "STONE texture not found at: " << stonePath << std::endl;
     }
     
     std::string floorPath = tilesPath + "/floor.png";
     if (std::filesystem::exists(floorPath)) {
-        m_tileTextures[Tile::TileType::FLOOR] = renderer->loadTexture(floorPath);
-        std::cout << "Loaded FLOOR texture: " << m_tileTextures[Tile::TileType::FLOOR] << std::endl;
+        m_tileTextures[Tile::TileType::FLOOR] = renderer->loadTextureAsync(floorPath);
+        std::cout << "Requested FLOOR texture: " << m_tileTextures[Tile::TileType::FLOOR] << std::endl;
     } else {
         std::cerr << "FLOOR texture not found at: " << floorPath << std::endl;
     }
     
     std::string sandPath = tilesPath + "/sand.png";
     if (std::filesystem::exists(sandPath)) {
-        m_tileTextures[Tile::TileType::SAND] = renderer->loadTexture(sandPath);
-        std::cout << "Loaded SAND texture: " << m_tileTextures[Tile::TileType::SAND] << std::endl;
+        m_tileTextures[Tile::TileType::SAND] = renderer->loadTextureAsync(sandPath);
+        std::cout << "Requested SAND texture: " << m_tileTextures[Tile::TileType::SAND] << std::endl;
     } else {
         std::cerr << "SAND texture not found at: " << sandPath << std::endl;
     }
     
     std::string doorPath = tilesPath + "/door.png";
     if (std::filesystem::exists(doorPath)) {
-        m_tileTextures[Tile::TileType::DOOR] = renderer->loadTexture(doorPath);
-        std::cout << "Loaded DOOR texture: " << m_tileTextures[Tile::TileType::DOOR] << std::endl;
+        m_tileTextures[Tile::TileType::DOOR] = renderer->loadTextureAsync(doorPath);
+        std::cout << "Requested DOOR texture: " << m_tileTextures[Tile::TileType::DOOR] << std::endl;
     } else {
         std::cerr << "DOOR texture not found at: " << doorPath << std::endl;
     }
+    
+    renderer->endTextureAtlas();
+    ++m_revision;
 }
 #endif
 
@@ -146,38 +169,18 @@ void Map::update(float deltaTime) {
 }
 
 #ifndef NO_VULKAN
-void Map::render(VulkanRenderer* renderer) {
-    // Render viewport of the map
-    // Screen is 800x600 (4:3 aspect ratio)
-    // To make square tiles, we need to account for screen aspect ratio
-    const int VIEWPORT_WIDTH = 15;  
-    const int VIEWPORT_HEIGHT = 15; // Same as width for square tiles
-    
-    int startX = (m_width > VIEWPORT_WIDTH) ? (m_width - VIEWPORT_WIDTH) / 2 : 0;
-    int startY = (m_height > VIEWPORT_HEIGHT) ? (m_height - VIEWPORT_HEIGHT) / 2 : 0;
-    int endX = (startX + VIEWPORT_WIDTH < m_width) ? startX + VIEWPORT_WIDTH : m_width;
-    int endY = (startY + VIEWPORT_HEIGHT < m_height) ? startY + VIEWPORT_HEIGHT : m_height;
-
-    // Screen aspect ratio: 800/600 = 1.333 (4:3)
-    // To make square tiles in screen space, we need to adjust for this
-    float screenAspect = 800.0f / 600.0f; // 4:3
-    
-    // Calculate tile size in normalized coordinates
-    float tileWidth = 2.0f / VIEWPORT_WIDTH;
-    float tileHeight = 2.0f / VIEWPORT_HEIGHT;
-    
-    // Adjust width to account for screen aspect ratio to make tiles square
-    tileWidth = tileHeight / screenAspect;
+void Map::render(VulkanRenderer* renderer, const float viewRect[4]) {
+    // Tile (x, y) covers [x, x+1) x [y, y+1) in world units
+    int startX = std::max(0, static_cast<int>(std::floor(viewRect[0])));
+    int startY = std::max(0, static_cast<int>(std::floor(viewRect[1])));
+    int endX = std::min(m_width, static_cast<int>(std::ceil(viewRect[2])));
+    int endY = std::min(m_height, static_cast<int>(std::ceil(viewRect[3])));
 
     // Render only the visible tiles
     for (int y = startY; y < endY; ++y) {
         for (int x = startX; x < endX; ++x) {
             Tile* tile = getTile(x, y);
             if (tile) {
-                // Position calculation: convert grid coordinates to normalized device coordinates
-                float normalizedX = -1.0f + (x - startX) * tileWidth + tileWidth * 0.5f;
-                float normalizedY = -1.0f + (y - startY) * tileHeight + tileHeight * 0.5f;
-
                 // Get texture index for this tile type
                 int textureIndex = -1;
                 auto it = m_tileTextures.find(tile->getType());
@@ -185,17 +188,30 @@ void Map::render(VulkanRenderer* renderer) {
                     textureIndex = it->second;
                 }
                 
-                // Render tile with square aspect ratio
                 if (textureIndex >= 0) {
-                    renderer->renderSpriteWithTexture(normalizedX, normalizedY, tileWidth, tileHeight, textureIndex);
+                    renderer->renderSpriteWithTexture(x + 0.5f, y + 0.5f, 1.0f, 1.0f, textureIndex);
                 } else {
                     // Fallback to default white sprite if no texture
-                    renderer->renderSprite(normalizedX, normalizedY, tileWidth, tileHeight);
+                    renderer->renderSprite(x + 0.5f, y + 0.5f, 1.0f, 1.0f);
                 }
             }
         }
     }
 }
+
+void Map::buildTileSprites(std::vector<SpriteInstance>& sprites, int fallbackTexture) const {
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            Tile* tile = getTile(x, y);
+            if (!tile) {
+                continue;
+            }
+            auto it = m_tileTextures.find(tile->getType());
+            sprites.push_back(SpriteInstance::make(x + 0.5f, y + 0.5f, 1.0f, 1.0f,
+                                                   it != m_tileTextures.end() && it->second >= 0 ? it->second : fallbackTexture));
+        }
+    }
+}
 #endif
 
 Tile* Map::getTile(int x, int y) const {
@@ -214,11 +230,13 @@ bool Map::isTileWalkable(int x, int y) const {
 void Map::setTile(int x, int y, std::unique_ptr<Tile> tile) {
     if (x >= 0 && x < m_width && y >= 0 && y < m_height) {
         m_tiles[y * m_width + x] = std::move(tile);
+        ++m_revision;
     }
 }
 
 void Map::addEnemy(std::unique_ptr<Enemy> enemy) {
     m_enemies.push_back(std::move(enemy));
+    ++m_revision;
 }
 
 void Map::removeEnemy(Enemy* enemy) {
@@ -226,6 +244,7 @@ void Map::removeEnemy(Enemy* enemy) {
     for (auto it = m_enemies.begin(); it != m_enemies.end(); ++it) {
         if (it->get() == enemy) {
             m_enemies.erase(it);
+            ++m_revision;
             break;
         }
     }
@@ -233,6 +252,7 @@ void Map::removeEnemy(Enemy* enemy) {
 
 void Map::addNPC(std::unique_ptr<NPC> npc) {
     m_npcs.push_back(std::move(npc));
+    ++m_revision;
 }
 
 void Map::removeNPC(NPC* npc) {
@@ -240,6 +260,7 @@ void Map::removeNPC(NPC* npc) {
     for (auto it = m_npcs.begin(); it != m_npcs.end(); ++it) {
         if (it->get() == npc) {
             m_npcs.erase(it);
+            ++m_revision;
             break;
         }
     }
@@ -51,6 +51,17 @@ void World::loadMapTextures(VulkanRenderer* renderer) {
     }
 }
 
+void World::releaseMapTextures(VulkanRenderer* renderer) {
+    if (!renderer) return;
+    
+    destroySpriteSets(renderer);
+    for (auto& map : m_maps) {
+        if (map) {
+            map->releaseTileTextures(renderer);
+        }
+    }
+}
+
 void World::update(float deltaTime) {
     if (m_currentMap) {
         m_currentMap->update(deltaTime);
@@ -59,26 +70,73 @@ void World::update(float deltaTime) {
 
 void World::render(VulkanRenderer* renderer) {
     if (m_currentMap) {
-        m_currentMap->render(renderer);
+        // With GPU culling the tiles live in a sprite set that is only re-uploaded when the map
+        // changes, so drawing them costs the CPU the same however large the map is
+        if (renderer->isGpuCullingAvailable() &&
+            (m_spriteSetMap != m_currentMap || m_spriteSetRevision != m_currentMap->getRevision())) {
+            rebuildSpriteSets(renderer);
+        }
+
+        // Everything here is in world units (tiles); the camera decides what is on screen
+        float viewRect[4];
+        renderer->getCamera().getVisibleRect(viewRect);
+        if (m_tileSpriteSet >= 0) {
+            renderer->drawSpriteSet(m_tileSpriteSet, viewRect[0], viewRect[1], viewRect[2], viewRect[3]);
+        } else {
+            m_currentMap->render(renderer, viewRect);
+        }
         
-        // Render entities on the map
+        // Entities are Y-sorted with the player above the tiles. They always go through the render
+        // queue: a sprite set draws in the order the cull pass compacts it, before the layer's
+        // queued sprites, which only suits content that never overlaps (the tiles).
+        renderer->setRenderLayer(RenderLayer::Entities);
         for (const auto& enemy : m_currentMap->getEnemies()) {
-            // Render a simple sprite for the enemy at its position
-            renderer->renderSprite(enemy->getX(), enemy->getY(), 0.1f, 0.1f);
+            // Render a simple sprite for the enemy on its tile
+            renderer->renderSpriteInstance(entitySprite(enemy->getX(), enemy->getY(), enemy->getAnimation(), renderer->getCurrentTexture()));
         }
         
         for (const auto& npc : m_currentMap->getNPCs()) {
-            // Render a simple sprite for the NPC at its position
-            renderer->renderSprite(npc->getX(), npc->getY(), 0.1f, 0.1f);
+            // Render a simple sprite for the NPC on its tile
+            renderer->renderSpriteInstance(entitySprite(npc->getX(), npc->getY(), npc->getAnimation(), renderer->getCurrentTexture()));
         }
         
-        // Render the player using Vulkan
-        if (m_player) {
-            // The player is rendered separately in the GameState
+        // Dungeons are dark apart from the torch the player carries; elsewhere the world is drawn as is
+        if (m_currentBiome == BiomeType::DUNGEON) {
+            renderer->setAmbientLight(0.15f, 0.15f, 0.2f);
+            if (m_player) {
+                renderer->addLight({{m_player->getX() + 0.5f, m_player->getY() + 0.5f}, 5.0f, 1.2f, {1.0f, 0.8f, 0.55f, 1.0f}});
+            }
+        } else {
+            renderer->setAmbientLight(1.0f, 1.0f, 1.0f);
         }
     }
 }
 
+SpriteInstance World::entitySprite(float x, float y, const AnimationPlayback& animation, int fallbackTexture) {
+    // One tile, centred on the entity's tile
+    if (animation.clip >= 0) {
+        return SpriteInstance::makeAnimated(x + 0.5f, y + 0.5f, 1.0f, 1.0f, animation);
+    }
+    return SpriteInstance::make(x + 0.5f, y + 0.5f, 1.0f, 1.0f, fallbackTexture);
+}
+
+void World::rebuildSpriteSets(VulkanRenderer* renderer) {
+    destroySpriteSets(renderer);
+
+    std::vector<SpriteInstance> sprites;
+    m_currentMap->buildTileSprites(sprites, renderer->getCurrentTexture());
+    m_tileSpriteSet = renderer->createSpriteSet(sprites);
+
+    m_spriteSetMap = m_currentMap;
+    m_spriteSetRevision = m_currentMap->getRevision();
+}
+
+void World::destroySpriteSets(VulkanRenderer* renderer) {
+    renderer->destroySpriteSet(m_tileSpriteSet);
+    m_tileSpriteSet = -1;
+    m_spriteSetMap = nullptr;
+}
+
 void World::loadMap(const std::string& mapName) {
     // In a real implementation, we would load the map from a file
     // For now, we'll just find the map in our existing maps
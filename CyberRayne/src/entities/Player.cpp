@@ -13,7 +13,8 @@ Player::Player(CharacterClass charClass, const std::string& name)
     : m_characterClass(charClass), m_name(name), m_level(1), m_health(100), m_mana(50),
       m_maxHealth(100), m_maxMana(50), m_strength(10), m_magic(10), m_speed(10), m_defense(10),
       m_x(0.0f), m_y(0.0f), m_startX(0.0f), m_startY(0.0f), m_targetX(0.0f), m_targetY(0.0f), 
-      m_isMoving(false), m_moveProgress(0.0f), m_moveSpeed(4.0f), m_textureIndex(-1) {
+      m_isMoving(false), m_moveProgress(0.0f), m_moveSpeed(4.0f), m_textureIndex(-1),
+      m_idleClip(-1), m_walkClip(-1) {
     initializeStats();
 }
 
@@ -22,7 +23,8 @@ Player::Player()
     : m_characterClass(CharacterClass::WARRIOR), m_name("DefaultPlayer"), m_level(1), 
       m_health(100), m_mana(50), m_maxHealth(100), m_maxMana(50), m_strength(10), m_magic(10), m_speed(10), m_defense(10),
       m_x(0.0f), m_y(0.0f), m_startX(0.0f), m_startY(0.0f), m_targetX(0.0f), m_targetY(0.0f), 
-      m_isMoving(false), m_moveProgress(0.0f), m_moveSpeed(4.0f), m_textureIndex(-1) {
+      m_isMoving(false), m_moveProgress(0.0f), m_moveSpeed(4.0f), m_textureIndex(-1),
+      m_idleClip(-1), m_walkClip(-1) {
     // Initialize with default values
 }
 
@@ -54,10 +56,34 @@ void Player::update(float deltaTime) {
     }
 }
 
+void Player::updateAnimation(float animationTime) {
+    // Only a change restarts the clip; frames are picked on the GPU from then on
+    const int clip = m_isMoving ? m_walkClip : m_idleClip;
+    if (clip != m_animation.clip) {
+        m_animation.clip = clip;
+        m_animation.startTime = animationTime;
+    }
+}
+
 #ifndef NO_VULKAN
+void Player::releaseTexture(VulkanRenderer* renderer) {
+    if (renderer && m_textureIndex >= 0) {
+        renderer->releaseTexture(m_textureIndex);
+    }
+    if (renderer && m_animation.sheetTexture >= 0) {
+        renderer->releaseTexture(m_animation.sheetTexture);
+    }
+    m_textureIndex = -1;
+    m_idleClip = m_walkClip = -1;
+    m_animation = AnimationPlayback{};
+}
+
 void Player::loadTexture(VulkanRenderer* renderer) {
     if (!renderer) return;
     
+    // Drop the reference from an earlier load (e.g. class change) before taking a new one
+    releaseTexture(renderer);
+    
     std::string base = renderer->getAssetsBasePath();
     std::string texturePath;
     
@@ -75,12 +101,22 @@ void Player::loadTexture(VulkanRenderer* renderer) {
     }
     
     if (std::filesystem::exists(texturePath)) {
-        m_textureIndex = renderer->loadTexture(texturePath);
-        std::cout << "Loaded player texture: " << texturePath << " (index: " << m_textureIndex << ")" << std::endl;
+        // Streamed in the background; the default texture is drawn until it is ready
+        m_textureIndex = renderer->loadTextureAsync(texturePath);
+        std::cout << "Requested player texture: " << texturePath << " (index: " << m_textureIndex << ")" << std::endl;
     } else {
         std::cerr << "Player texture not found: " << texturePath << std::endl;
         m_textureIndex = -1;
     }
+
+    // Animated sheet for the class, if there is one; the clips are shared with any earlier load
+    const std::string sheetPath = texturePath.substr(0, texturePath.size() - 4) + "_sheet.png";
+    if (std::filesystem::exists(sheetPath)) {
+        m_animation.sheetTexture = renderer->loadTextureAsync(sheetPath, TextureFilter::Nearest);
+        m_idleClip = renderer->createAnimationClip(m_animation.sheetTexture, gridAnimationFrames(4, 2, 0, 4, 0.2f), AnimationLoop::Loop);
+        m_walkClip = renderer->createAnimationClip(m_animation.sheetTexture, gridAnimationFrames(4, 2, 4, 4, 0.1f), AnimationLoop::Loop);
+        std::cout << "Requested player sprite sheet: " << sheetPath << " (clips " << m_idleClip << ", " << m_walkClip << ")" << std::endl;
+    }
 }
 
 void Player::render(VulkanRenderer* renderer) {
@@ -0,0 +1,85 @@
+#include "../../include/BuddyAllocator.h"
+#include <algorithm>
+
+BuddyAllocator::BuddyAllocator(uint64_t size, uint64_t minBlockSize) {
+    m_minBlockSize = roundUpToPowerOfTwo(std::max<uint64_t>(minBlockSize, 1));
+    m_size = std::max(roundUpToPowerOfTwo(size), m_minBlockSize);
+    m_levelCount = 1;
+    while ((m_size >> (m_levelCount - 1)) > m_minBlockSize) {
+        ++m_levelCount;
+    }
+    m_freeBlocks.resize(m_levelCount);
+    m_freeBlocks[0].insert(0);
+}
+
+uint64_t BuddyAllocator::roundUpToPowerOfTwo(uint64_t value) {
+    uint64_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+bool BuddyAllocator::allocate(uint64_t size, uint64_t alignment, uint64_t& offset) {
+    uint64_t needed = roundUpToPowerOfTwo(std::max({size, alignment, m_minBlockSize}));
+    if (size == 0 || needed > m_size) {
+        return false;
+    }
+    uint32_t level = 0;
+    while (blockSize(level) > needed) {
+        ++level;
+    }
+
+    // Smallest free block that fits, split down to the wanted size
+    int source = static_cast<int>(level);
+    while (source >= 0 && m_freeBlocks[source].empty()) {
+        --source;
+    }
+    if (source < 0) {
+        return false;
+    }
+    uint64_t block = *m_freeBlocks[source].begin();
+    m_freeBlocks[source].erase(m_freeBlocks[source].begin());
+    for (uint32_t split = static_cast<uint32_t>(source) + 1; split <= level; ++split) {
+        // Keep the low half, free the high one
+        m_freeBlocks[split].insert(block + blockSize(split));
+    }
+
+    m_allocated[block] = level;
+    m_used += blockSize(level);
+    offset = block;
+    return true;
+}
+
+void BuddyAllocator::free(uint64_t offset) {
+    auto it = m_allocated.find(offset);
+    if (it == m_allocated.end()) {
+        return;
+    }
+    uint32_t level = it->second;
+    m_allocated.erase(it);
+    m_used -= blockSize(level);
+
+    // Merge with the buddy for as long as it is free too
+    uint64_t block = offset;
+    while (level > 0) {
+        uint64_t buddy = block ^ blockSize(level);
+        auto buddyIt = m_freeBlocks[level].find(buddy);
+        if (buddyIt == m_freeBlocks[level].end()) {
+            break;
+        }
+        m_freeBlocks[level].erase(buddyIt);
+        block = std::min(block, buddy);
+        --level;
+    }
+    m_freeBlocks[level].insert(block);
+}
+
+uint64_t BuddyAllocator::getLargestFreeBlock() const {
+    for (uint32_t level = 0; level < m_levelCount; ++level) {
+        if (!m_freeBlocks[level].empty()) {
+            return blockSize(level);
+        }
+    }
+    return 0;
+}
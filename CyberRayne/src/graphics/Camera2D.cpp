@@ -0,0 +1,86 @@
+#include "../../include/Camera2D.h"
+#include <algorithm>
+#include <cmath>
+
+void Camera2D::setViewportSize(float width, float height) {
+    if (width > 0.0f && height > 0.0f) {
+        m_viewportWidth = width;
+        m_viewportHeight = height;
+    }
+}
+
+void Camera2D::setPosition(float x, float y) {
+    m_x = m_targetX = x;
+    m_y = m_targetY = y;
+}
+
+void Camera2D::update(float deltaTime) {
+    if (m_smoothing <= 0.0f) {
+        snapToTarget();
+        return;
+    }
+    // Exponential approach: the same distance is covered per second whatever the frame rate
+    const float t = 1.0f - std::exp(-deltaTime / m_smoothing);
+    m_x += (m_targetX - m_x) * t;
+    m_y += (m_targetY - m_y) * t;
+}
+
+void Camera2D::setBounds(float minX, float minY, float maxX, float maxY) {
+    m_hasBounds = maxX > minX && maxY > minY;
+    m_bounds[0] = minX;
+    m_bounds[1] = minY;
+    m_bounds[2] = maxX;
+    m_bounds[3] = maxY;
+}
+
+float Camera2D::getVisibleWidth() const {
+    return getVisibleHeight() * m_viewportWidth / m_viewportHeight;
+}
+
+void Camera2D::getCenter(float& x, float& y) const {
+    x = m_x;
+    y = m_y;
+    if (m_hasBounds) {
+        auto clampAxis = [](float value, float halfExtent, float min, float max) {
+            return max - min <= halfExtent * 2.0f ? (min + max) * 0.5f : std::clamp(value, min + halfExtent, max - halfExtent);
+        };
+        x = clampAxis(x, getVisibleWidth() * 0.5f, m_bounds[0], m_bounds[2]);
+        y = clampAxis(y, getVisibleHeight() * 0.5f, m_bounds[1], m_bounds[3]);
+    }
+
+    // Whole pixels only, so nearest-filtered tiles don't shimmer while the camera glides
+    const float pixelsPerUnit = m_viewportHeight / getVisibleHeight();
+    x = std::round(x * pixelsPerUnit) / pixelsPerUnit;
+    y = std::round(y * pixelsPerUnit) / pixelsPerUnit;
+}
+
+void Camera2D::getVisibleRect(float rect[4]) const {
+    float x, y;
+    getCenter(x, y);
+    const float halfWidth = getVisibleWidth() * 0.5f;
+    const float halfHeight = getVisibleHeight() * 0.5f;
+    rect[0] = x - halfWidth;
+    rect[1] = y - halfHeight;
+    rect[2] = x + halfWidth;
+    rect[3] = y + halfHeight;
+}
+
+void Camera2D::identity(float out[16]) {
+    for (int i = 0; i < 16; ++i) {
+        out[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+}
+
+void Camera2D::getViewMatrix(float out[16]) const {
+    float x, y;
+    getCenter(x, y);
+    identity(out);
+    out[12] = -x;
+    out[13] = -y;
+}
+
+void Camera2D::getProjectionMatrix(float out[16]) const {
+    identity(out);
+    out[0] = 2.0f / getVisibleWidth();
+    out[5] = 2.0f / getVisibleHeight();
+}
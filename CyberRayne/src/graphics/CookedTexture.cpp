@@ -0,0 +1,209 @@
+#include "../../include/CookedTexture.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+#ifdef _WIN32
+ #include <windows.h>
+#else
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
+namespace {
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Levels from width x height down to 1x1
+    uint32_t fullMipCount(uint32_t width, uint32_t height) {
+        uint32_t count = 1;
+        for (uint32_t edge = std::max(width, height); edge > 1; edge >>= 1) {
+            ++count;
+        }
+        return count;
+    }
+}
+
+CookedTextureFile::~CookedTextureFile() {
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    if (m_fileHandle) CloseHandle(static_cast<HANDLE>(m_fileHandle));
+#else
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+}
+
+std::shared_ptr<CookedTextureFile> CookedTextureFile::open(const std::string& path) {
+    std::shared_ptr<CookedTextureFile> file(new CookedTextureFile());
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    file->m_fileHandle = handle;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(CookedTextureHeader))) {
+        return nullptr;
+    }
+    file->m_size = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        return nullptr;
+    }
+    file->m_mappingHandle = mapping;
+    file->m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!file->m_data) {
+        return nullptr;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CookedTextureHeader))) {
+        ::close(fd);
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    file->m_data = static_cast<const uint8_t*>(mapped);
+    file->m_size = static_cast<size_t>(st.st_size);
+#endif
+
+    if (!file->validate()) {
+        std::cerr << "Ignoring invalid cooked texture: " << path << std::endl;
+        return nullptr;
+    }
+    return file;
+}
+
+bool CookedTextureFile::validate() const {
+    const CookedTextureHeader& header = getHeader();
+    if (std::memcmp(header.magic, COOKED_TEXTURE_MAGIC, 4) != 0 || header.version != COOKED_TEXTURE_VERSION) {
+        return false;
+    }
+    if (header.mipCount == 0 || header.width == 0 || header.height == 0) {
+        return false;
+    }
+    if (header.width > COOKED_TEXTURE_MAX_EXTENT || header.height > COOKED_TEXTURE_MAX_EXTENT ||
+        header.mipCount > fullMipCount(header.width, header.height)) {
+        return false;
+    }
+    const uint64_t tableEnd = sizeof(CookedTextureHeader) + static_cast<uint64_t>(header.mipCount) * sizeof(CookedTextureLevel);
+    if (tableEnd > m_size) {
+        return false;
+    }
+
+    // Levels are exactly what write() lays out: halved sizes, tightly packed in order after the
+    // table, each on an aligned offset. The renderer uploads the chain as one contiguous range.
+    uint64_t expectedOffset = alignUp(tableEnd, COOKED_TEXTURE_ALIGNMENT);
+    for (uint32_t i = 0; i < header.mipCount; ++i) {
+        const CookedTextureLevel& level = getLevel(i);
+        if (level.width != std::max(1u, header.width >> i) || level.height != std::max(1u, header.height >> i)) {
+            return false;
+        }
+        if (level.size != static_cast<uint64_t>(level.width) * level.height * 4 || level.offset != expectedOffset) {
+            return false;
+        }
+        if (level.offset > m_size || level.size > m_size - level.offset) {
+            return false;
+        }
+        expectedOffset = alignUp(level.offset + level.size, COOKED_TEXTURE_ALIGNMENT);
+    }
+    return true;
+}
+
+const CookedTextureLevel& CookedTextureFile::getLevel(uint32_t level) const {
+    const uint8_t* table = m_data + sizeof(CookedTextureHeader);
+    return reinterpret_cast<const CookedTextureLevel*>(table)[level];
+}
+
+std::string CookedTextureFile::cookedPathFor(const std::string& sourcePath) {
+    std::filesystem::path cooked(sourcePath);
+    cooked.replace_extension(".crtex");
+    return cooked.string();
+}
+
+std::shared_ptr<CookedTextureFile> CookedTextureFile::openForSource(const std::string& sourcePath) {
+    // Freshness is the cooker's job (it compares against the source tree); the copied PNGs in the
+    // build directory get new timestamps on every build, so comparing here would reject good files
+    std::string cookedPath = cookedPathFor(sourcePath);
+    std::error_code ec;
+    if (!std::filesystem::exists(cookedPath, ec)) {
+        return nullptr;
+    }
+    return open(cookedPath);
+}
+
+bool CookedTextureFile::write(const std::string& path, const std::vector<ImageData>& levels, uint32_t flags) {
+    if (levels.empty()) {
+        return false;
+    }
+
+    CookedTextureHeader header{};
+    std::memcpy(header.magic, COOKED_TEXTURE_MAGIC, 4);
+    header.version = COOKED_TEXTURE_VERSION;
+    header.width = static_cast<uint32_t>(levels[0].width);
+    header.height = static_cast<uint32_t>(levels[0].height);
+    header.mipCount = static_cast<uint32_t>(levels.size());
+    header.flags = flags;
+
+    std::vector<CookedTextureLevel> table(levels.size());
+    uint64_t offset = alignUp(sizeof(CookedTextureHeader) + table.size() * sizeof(CookedTextureLevel), COOKED_TEXTURE_ALIGNMENT);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        table[i].width = static_cast<uint32_t>(levels[i].width);
+        table[i].height = static_cast<uint32_t>(levels[i].height);
+        table[i].offset = offset;
+        table[i].size = levels[i].pixels.size();
+        offset = alignUp(offset + table[i].size, COOKED_TEXTURE_ALIGNMENT);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to open for writing: " << path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(CookedTextureLevel)));
+    for (size_t i = 0; i < levels.size(); ++i) {
+        // Zero padding up to the level's aligned offset
+        std::streamoff position = out.tellp();
+        std::vector<char> padding(static_cast<size_t>(table[i].offset - static_cast<uint64_t>(position)), 0);
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char*>(levels[i].pixels.data()), static_cast<std::streamsize>(levels[i].pixels.size()));
+    }
+    return static_cast<bool>(out);
+}
+
+uint32_t CookedTextureFile::findLevelForSize(int maxSize) const {
+    if (maxSize <= 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < getMipCount(); ++i) {
+        const CookedTextureLevel& level = getLevel(i);
+        if (static_cast<int>(level.width) <= maxSize && static_cast<int>(level.height) <= maxSize) {
+            return i;
+        }
+    }
+    return getMipCount() - 1;
+}
+
+ImageData CookedTextureFile::levelToImage(uint32_t level) const {
+    const CookedTextureLevel& info = getLevel(level);
+    ImageData image;
+    image.width = static_cast<int>(info.width);
+    image.height = static_cast<int>(info.height);
+    image.pixels.assign(getLevelData(level), getLevelData(level) + info.size);
+    image.premultiplied = (getHeader().flags & COOKED_TEXTURE_PREMULTIPLIED) != 0;
+    return image;
+}
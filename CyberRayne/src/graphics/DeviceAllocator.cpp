@@ -0,0 +1,253 @@
+#include "../../include/DeviceAllocator.h"
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+void DeviceAllocator::initialize(VkPhysicalDevice physicalDevice, VkDevice device) {
+    m_device = device;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+    std::cout << "Device allocator: bufferImageGranularity " << m_bufferImageGranularity
+              << (m_bufferImageGranularity > MIN_BUDDY_BLOCK ? " (buffers and images in separate blocks)" : "") << std::endl;
+}
+
+void DeviceAllocator::destroy() {
+    logStats();
+    for (Pool& pool : m_pools) {
+        for (Block& block : pool.blocks) {
+            if (block.memory != VK_NULL_HANDLE) {
+                vkFreeMemory(m_device, block.memory, nullptr);
+            }
+        }
+    }
+    m_pools.clear();
+}
+
+uint32_t DeviceAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+int DeviceAllocator::getPool(uint32_t memoryTypeIndex, ResourceKind kind) {
+    // With a fine granularity, buddy alignment already keeps buffers and images off each other's
+    // pages. Textures stay apart regardless so that their blocks can be emptied by moving them.
+    if (kind == ResourceKind::Optimal && m_bufferImageGranularity <= MIN_BUDDY_BLOCK) {
+        kind = ResourceKind::Linear;
+    }
+    for (size_t i = 0; i < m_pools.size(); ++i) {
+        if (m_pools[i].memoryTypeIndex == memoryTypeIndex && m_pools[i].kind == kind) {
+            return static_cast<int>(i);
+        }
+    }
+
+    // Small heaps (e.g. a 256 MB host-visible BAR) get smaller blocks so one block can't take it all
+    Pool pool;
+    pool.memoryTypeIndex = memoryTypeIndex;
+    pool.kind = kind;
+    VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+    pool.blockSize = DEFAULT_BLOCK_SIZE;
+    while (pool.blockSize > 1024 * 1024 && pool.blockSize > heapSize / 8) {
+        pool.blockSize /= 2;
+    }
+    m_pools.push_back(std::move(pool));
+    return static_cast<int>(m_pools.size() - 1);
+}
+
+VkDeviceMemory DeviceAllocator::allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size, void** mapped) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+
+    *mapped = nullptr;
+    if (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        if (vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+            vkFreeMemory(m_device, memory, nullptr);
+            throw std::runtime_error("failed to map device memory!");
+        }
+    }
+    return memory;
+}
+
+DeviceAllocation DeviceAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+    int poolIndex = getPool(memoryTypeIndex, kind);
+    Pool& pool = m_pools[poolIndex];
+
+    DeviceAllocation allocation;
+    allocation.pool = poolIndex;
+    allocation.size = requirements.size;
+
+    // Large resources get their own memory rather than most of a block
+    if (requirements.size > pool.blockSize / 2) {
+        void* mapped;
+        allocation.memory = allocateMemory(memoryTypeIndex, requirements.size, &mapped);
+        allocation.mapped = mapped;
+        ++m_dedicatedCount;
+        m_dedicatedBytes += requirements.size;
+        return allocation;
+    }
+
+    auto place = [&](size_t blockIndex) {
+        Block& block = pool.blocks[blockIndex];
+        uint64_t offset;
+        if (block.memory == VK_NULL_HANDLE || block.evacuating || !block.buddy->allocate(requirements.size, requirements.alignment, offset)) {
+            return false;
+        }
+        allocation.memory = block.memory;
+        allocation.offset = offset;
+        allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+        allocation.block = static_cast<int32_t>(blockIndex);
+        return true;
+    };
+    for (size_t i = 0; i < pool.blocks.size(); ++i) {
+        if (place(i)) {
+            return allocation;
+        }
+    }
+
+    // No room: new block, reusing a released slot if there is one
+    size_t blockIndex = 0;
+    while (blockIndex < pool.blocks.size() && pool.blocks[blockIndex].memory != VK_NULL_HANDLE) {
+        ++blockIndex;
+    }
+    if (blockIndex == pool.blocks.size()) {
+        pool.blocks.emplace_back();
+    }
+    Block& block = pool.blocks[blockIndex];
+    void* mapped;
+    block.memory = allocateMemory(memoryTypeIndex, pool.blockSize, &mapped);
+    block.mapped = static_cast<uint8_t*>(mapped);
+    block.buddy = std::make_unique<BuddyAllocator>(pool.blockSize, MIN_BUDDY_BLOCK);
+    block.evacuating = false;
+    if (!place(blockIndex)) {
+        throw std::runtime_error("failed to sub-allocate device memory!");
+    }
+    return allocation;
+}
+
+void DeviceAllocator::free(DeviceAllocation& allocation) {
+    if (allocation.memory == VK_NULL_HANDLE) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (allocation.block < 0) {
+        vkFreeMemory(m_device, allocation.memory, nullptr);
+        --m_dedicatedCount;
+        m_dedicatedBytes -= allocation.size;
+    } else {
+        Pool& pool = m_pools[allocation.pool];
+        Block& block = pool.blocks[allocation.block];
+        block.buddy->free(allocation.offset);
+        if (block.buddy->isEmpty()) {
+            releaseEmptyBlock(pool, allocation.block);
+        }
+    }
+    allocation = DeviceAllocation{};
+}
+
+void DeviceAllocator::releaseEmptyBlock(Pool& pool, size_t blockIndex) {
+    // Keep one block per pool so a pool that empties and refills doesn't churn vkAllocateMemory
+    bool otherLiveBlock = false;
+    for (size_t i = 0; i < pool.blocks.size(); ++i) {
+        otherLiveBlock = otherLiveBlock || (i != blockIndex && pool.blocks[i].memory != VK_NULL_HANDLE);
+    }
+    Block& block = pool.blocks[blockIndex];
+    if (!otherLiveBlock && !block.evacuating) {
+        return;
+    }
+    vkFreeMemory(m_device, block.memory, nullptr);
+    block = Block{};
+}
+
+DeviceAllocator::Stats DeviceAllocator::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    for (const Pool& pool : m_pools) {
+        for (const Block& block : pool.blocks) {
+            if (block.memory == VK_NULL_HANDLE) {
+                continue;
+            }
+            ++stats.blockCount;
+            stats.blockBytes += pool.blockSize;
+            stats.usedBytes += block.buddy->getUsed();
+            stats.allocationCount += block.buddy->getAllocationCount();
+        }
+    }
+    stats.dedicatedCount = m_dedicatedCount;
+    stats.dedicatedBytes = m_dedicatedBytes;
+    stats.allocationCount += m_dedicatedCount;
+    return stats;
+}
+
+void DeviceAllocator::logStats() const {
+    Stats stats = getStats();
+    std::cout << "Device memory: " << stats.allocationCount << " allocations in " << stats.blockCount << " blocks ("
+              << stats.usedBytes / 1024 << " of " << stats.blockBytes / 1024 << " KB used) + "
+              << stats.dedicatedCount << " dedicated (" << stats.dedicatedBytes / 1024 << " KB), "
+              << (stats.blockCount + stats.dedicatedCount) << " VkDeviceMemory objects" << std::endl;
+}
+
+bool DeviceAllocator::beginDefragmentation() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool any = false;
+    for (Pool& pool : m_pools) {
+        // Only textures can be moved; blocks holding anything else would never empty
+        if (pool.kind != ResourceKind::Texture) {
+            continue;
+        }
+
+        // Evacuate the emptiest blocks while the rest of the pool can take their contents
+        std::vector<size_t> candidates;
+        VkDeviceSize spare = 0;
+        for (size_t i = 0; i < pool.blocks.size(); ++i) {
+            const Block& block = pool.blocks[i];
+            if (block.memory == VK_NULL_HANDLE) {
+                continue;
+            }
+            spare += pool.blockSize - block.buddy->getUsed();
+            if (!block.buddy->isEmpty() && block.buddy->getUsed() < pool.blockSize * EVACUATE_BELOW_USAGE) {
+                candidates.push_back(i);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+            return pool.blocks[a].buddy->getUsed() < pool.blocks[b].buddy->getUsed();
+        });
+        for (size_t i : candidates) {
+            // An evacuated block's free space stops counting and its contents need room elsewhere:
+            // a block's worth of spare space either way
+            if (spare < pool.blockSize) {
+                break;
+            }
+            spare -= pool.blockSize;
+            pool.blocks[i].evacuating = true;
+            any = true;
+        }
+    }
+    return any;
+}
+
+bool DeviceAllocator::isEvacuating(const DeviceAllocation& allocation) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return allocation.block >= 0 && m_pools[allocation.pool].blocks[allocation.block].evacuating;
+}
+
+void DeviceAllocator::endDefragmentation() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Pool& pool : m_pools) {
+        for (Block& block : pool.blocks) {
+            block.evacuating = false;
+        }
+    }
+}
@@ -0,0 +1,240 @@
+#include "../../include/FrameGraph.h"
+#include <algorithm>
+#include <stdexcept>
+
+void FrameGraph::reset() {
+    m_passes.clear();
+    m_resources.clear();
+    m_schedule.clear();
+    m_finalBarriers.clear();
+    m_heapSize = 0;
+    m_transientBytes = 0;
+}
+
+int FrameGraph::importImage(const std::string& name, Usage initial, Usage final) {
+    Resource resource;
+    resource.name = name;
+    resource.initial = initial;
+    resource.final = final;
+    m_resources.push_back(resource);
+    return static_cast<int>(m_resources.size() - 1);
+}
+
+int FrameGraph::createTransient(const std::string& name, uint64_t size, uint64_t alignment) {
+    Resource resource;
+    resource.name = name;
+    resource.transient = true;
+    resource.size = size;
+    resource.alignment = std::max<uint64_t>(alignment, 1);
+    m_resources.push_back(resource);
+    return static_cast<int>(m_resources.size() - 1);
+}
+
+int FrameGraph::addPass(const std::string& name, std::function<void()> execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+    return static_cast<int>(m_passes.size() - 1);
+}
+
+void FrameGraph::addUse(int pass, int resource, Usage usage, Access access) {
+    if (pass < 0 || pass >= static_cast<int>(m_passes.size()) || resource < 0 || resource >= static_cast<int>(m_resources.size())) {
+        throw std::runtime_error("frame graph: use of an unknown pass or resource");
+    }
+    m_passes[pass].uses.push_back({resource, usage, access});
+}
+
+void FrameGraph::read(int pass, int resource, Usage usage) {
+    addUse(pass, resource, usage, Access::Read);
+}
+
+void FrameGraph::write(int pass, int resource, Usage usage) {
+    addUse(pass, resource, usage, Access::Write);
+}
+
+void FrameGraph::modify(int pass, int resource, Usage usage) {
+    addUse(pass, resource, usage, Access::Modify);
+}
+
+void FrameGraph::setSideEffect(int pass) {
+    m_passes[pass].sideEffect = true;
+}
+
+void FrameGraph::cullPasses() {
+    // Walk backwards from the outputs: a pass lives if it writes something still needed later, and
+    // then needs what it reads. A full overwrite ends the need for the earlier contents.
+    std::vector<bool> needed(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        needed[i] = !m_resources[i].transient && m_resources[i].final != Usage::None;
+    }
+    for (int p = static_cast<int>(m_passes.size()) - 1; p >= 0; --p) {
+        Pass& pass = m_passes[p];
+        pass.live = pass.sideEffect;
+        for (const Use& use : pass.uses) {
+            if (use.access != Access::Read && needed[use.resource]) {
+                pass.live = true;
+            }
+        }
+        if (!pass.live) {
+            continue;
+        }
+        for (const Use& use : pass.uses) {
+            if (use.access == Access::Write) {
+                needed[use.resource] = false;
+            }
+        }
+        for (const Use& use : pass.uses) {
+            if (use.access != Access::Write) {
+                needed[use.resource] = true;
+            }
+        }
+    }
+}
+
+void FrameGraph::placeTransients() {
+    std::vector<int> order;
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        if (m_resources[i].transient && m_resources[i].firstUse >= 0) {
+            order.push_back(static_cast<int>(i));
+        }
+    }
+    // Largest first, each at the lowest offset clear of every placed image it is alive alongside
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return m_resources[a].size > m_resources[b].size; });
+
+    std::vector<int> placed;
+    std::vector<uint64_t> candidates;
+    for (int index : order) {
+        Resource& resource = m_resources[index];
+        auto alignUp = [&resource](uint64_t offset) { return (offset + resource.alignment - 1) / resource.alignment * resource.alignment; };
+        auto overlapsLifetime = [&resource](const Resource& other) {
+            return resource.firstUse <= other.lastUse && other.firstUse <= resource.lastUse;
+        };
+
+        candidates.assign(1, 0);
+        for (int other : placed) {
+            if (overlapsLifetime(m_resources[other])) {
+                candidates.push_back(alignUp(m_resources[other].offset + m_resources[other].size));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (uint64_t candidate : candidates) {
+            bool clear = true;
+            for (int other : placed) {
+                const Resource& o = m_resources[other];
+                if (overlapsLifetime(o) && candidate < o.offset + o.size && o.offset < candidate + resource.size) {
+                    clear = false;
+                    break;
+                }
+            }
+            if (clear) {
+                resource.offset = candidate;
+                break;
+            }
+        }
+        placed.push_back(index);
+        m_heapSize = std::max(m_heapSize, resource.offset + resource.size);
+        m_transientBytes += resource.size;
+    }
+}
+
+bool FrameGraph::sharesMemory(const Resource& a, const Resource& b) const {
+    return a.offset != UINT64_MAX && b.offset != UINT64_MAX && a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+void FrameGraph::compile() {
+    m_schedule.clear();
+    m_finalBarriers.clear();
+    m_heapSize = 0;
+    m_transientBytes = 0;
+    for (Resource& resource : m_resources) {
+        resource.firstUse = resource.lastUse = -1;
+        resource.offset = UINT64_MAX;
+        resource.lastUsage = resource.initial;
+        resource.tailUsages = 0;
+        resource.tailWrote = false;
+    }
+
+    cullPasses();
+    for (size_t p = 0; p < m_passes.size(); ++p) {
+        if (!m_passes[p].live) {
+            continue;
+        }
+        const int index = static_cast<int>(m_schedule.size());
+        m_schedule.push_back({static_cast<int>(p), {}});
+        for (const Use& use : m_passes[p].uses) {
+            Resource& resource = m_resources[use.resource];
+            if (resource.firstUse < 0) {
+                resource.firstUse = index;
+            }
+            resource.lastUse = index;
+        }
+    }
+    placeTransients();
+
+    // Follow each image through the schedule. A transient's first use discards its contents and has
+    // to wait for whatever last used its memory: other transients aliased onto it, and its own last
+    // use in the previous frame, since the heap is shared between frames in flight. Those tails are
+    // only known at the end, so the discards are completed afterwards.
+    std::vector<std::pair<size_t, size_t>> discards;
+    for (size_t s = 0; s < m_schedule.size(); ++s) {
+        ScheduledPass& scheduled = m_schedule[s];
+        for (const Use& use : m_passes[scheduled.pass].uses) {
+            Resource& resource = m_resources[use.resource];
+            const bool reading = use.access == Access::Read;
+            const bool firstUse = resource.firstUse == static_cast<int>(s) && resource.tailUsages == 0;
+            if (firstUse && resource.transient) {
+                discards.push_back({s, scheduled.barriers.size()});
+                scheduled.barriers.push_back({use.resource, Usage::None, use.usage, 0, false});
+            } else if (firstUse) {
+                // Imports arrive with any earlier work already synchronised
+                if (resource.initial != use.usage) {
+                    scheduled.barriers.push_back({use.resource, resource.initial, use.usage, usageBit(resource.initial), false});
+                }
+            } else if (reading && !resource.tailWrote && resource.lastUsage == use.usage) {
+                // Another read in the same layout
+                resource.tailUsages |= usageBit(use.usage);
+                continue;
+            } else {
+                scheduled.barriers.push_back({use.resource, resource.lastUsage, use.usage, resource.tailUsages, resource.tailWrote});
+            }
+            resource.lastUsage = use.usage;
+            resource.tailUsages = usageBit(use.usage);
+            resource.tailWrote = !reading;
+        }
+    }
+
+    for (const auto& [s, b] : discards) {
+        Barrier& barrier = m_schedule[s].barriers[b];
+        const Resource& resource = m_resources[barrier.resource];
+        for (const Resource& other : m_resources) {
+            if (other.transient && sharesMemory(resource, other)) {
+                barrier.waitUsages |= other.tailUsages;
+                barrier.flushWrites = barrier.flushWrites || other.tailWrote;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m_resources.size(); ++i) {
+        const Resource& resource = m_resources[i];
+        if (resource.transient || resource.final == Usage::None || resource.lastUsage == resource.final) {
+            continue;
+        }
+        const uint32_t wait = resource.tailUsages != 0 ? resource.tailUsages : usageBit(resource.initial);
+        m_finalBarriers.push_back({static_cast<int>(i), resource.lastUsage, resource.final, wait, resource.tailWrote});
+    }
+}
+
+void FrameGraph::execute(const std::function<void(const std::vector<Barrier>&)>& emitBarriers) {
+    for (const ScheduledPass& scheduled : m_schedule) {
+        if (!scheduled.barriers.empty()) {
+            emitBarriers(scheduled.barriers);
+        }
+        if (m_passes[scheduled.pass].execute) {
+            m_passes[scheduled.pass].execute();
+        }
+    }
+    if (!m_finalBarriers.empty()) {
+        emitBarriers(m_finalBarriers);
+    }
+}
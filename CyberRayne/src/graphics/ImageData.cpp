@@ -0,0 +1,154 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../include/ImageData.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // Textures are sampled as R8G8B8A8_SRGB, so the GPU filters and blends in linear light. The CPU
+    // premultiplies and averages colour in linear light too, matching the blitted mip levels.
+    const std::array<float, 256>& srgbToLinearTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values{};
+            for (int i = 0; i < 256; ++i) {
+                float c = static_cast<float>(i) / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    uint8_t linearToSrgb(float linear) {
+        linear = std::clamp(linear, 0.0f, 1.0f);
+        float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(c * 255.0f + 0.5f);
+    }
+}
+
+bool ImageData::loadFromFile(const std::string& path, ImageData& out) {
+    int texWidth, texHeight, texChannels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        std::cerr << "Failed to load texture image: " << path << std::endl;
+        std::cerr << "  STB error: " << stbi_failure_reason() << std::endl;
+        return false;
+    }
+
+    out.width = texWidth;
+    out.height = texHeight;
+    out.pixels.assign(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+ImageData ImageData::downscaledToFit(int maxSize) const {
+    if (maxSize <= 0 || (width <= maxSize && height <= maxSize)) {
+        return *this;
+    }
+
+    float scale = static_cast<float>(maxSize) / static_cast<float>(std::max(width, height));
+    ImageData result;
+    result.width = std::max(1, static_cast<int>(width * scale + 0.5f));
+    result.height = std::max(1, static_cast<int>(height * scale + 0.5f));
+    result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+    result.premultiplied = premultiplied;
+
+    // Average every source pixel that falls inside each destination pixel
+    const std::array<float, 256>& toLinear = srgbToLinearTable();
+    for (int dy = 0; dy < result.height; ++dy) {
+        int sy0 = dy * height / result.height;
+        int sy1 = std::max(sy0 + 1, (dy + 1) * height / result.height);
+        for (int dx = 0; dx < result.width; ++dx) {
+            int sx0 = dx * width / result.width;
+            int sx1 = std::max(sx0 + 1, (dx + 1) * width / result.width);
+            float colour[3] = {0.0f, 0.0f, 0.0f};
+            uint32_t alpha = 0;
+            for (int sy = sy0; sy < sy1; ++sy) {
+                const uint8_t* row = &pixels[(static_cast<size_t>(sy) * width + sx0) * 4];
+                for (int sx = sx0; sx < sx1; ++sx, row += 4) {
+                    colour[0] += toLinear[row[0]];
+                    colour[1] += toLinear[row[1]];
+                    colour[2] += toLinear[row[2]];
+                    alpha += row[3];
+                }
+            }
+            uint32_t count = static_cast<uint32_t>((sy1 - sy0) * (sx1 - sx0));
+            uint8_t* out = &result.pixels[(static_cast<size_t>(dy) * result.width + dx) * 4];
+            for (int c = 0; c < 3; ++c) {
+                out[c] = linearToSrgb(colour[c] / static_cast<float>(count));
+            }
+            out[3] = static_cast<uint8_t>((alpha + count / 2) / count);
+        }
+    }
+    return result;
+}
+
+void ImageData::blitInto(ImageData& dst, int x, int y, int extrude) const {
+    for (int row = -extrude; row < height + extrude; ++row) {
+        int dstY = y + row;
+        if (dstY < 0 || dstY >= dst.height) continue;
+        int srcY = std::clamp(row, 0, height - 1);
+        for (int col = -extrude; col < width + extrude; ++col) {
+            int dstX = x + col;
+            if (dstX < 0 || dstX >= dst.width) continue;
+            int srcX = std::clamp(col, 0, width - 1);
+            std::memcpy(&dst.pixels[(static_cast<size_t>(dstY) * dst.width + dstX) * 4],
+                        &pixels[(static_cast<size_t>(srcY) * width + srcX) * 4], 4);
+        }
+    }
+}
+
+void ImageData::premultiplyAlpha() {
+    if (premultiplied) {
+        return;
+    }
+    const std::array<float, 256>& toLinear = srgbToLinearTable();
+    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
+        float alpha = static_cast<float>(pixels[i + 3]) / 255.0f;
+        for (size_t c = 0; c < 3; ++c) {
+            pixels[i + c] = linearToSrgb(toLinear[pixels[i + c]] * alpha);
+        }
+    }
+    premultiplied = true;
+}
+
+ImageData ImageData::halfSize() const {
+    ImageData result;
+    result.width = std::max(1, width / 2);
+    result.height = std::max(1, height / 2);
+    result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+    result.premultiplied = premultiplied;
+
+    const std::array<float, 256>& toLinear = srgbToLinearTable();
+    for (int dy = 0; dy < result.height; ++dy) {
+        int sy0 = std::min(dy * 2, height - 1);
+        int sy1 = std::min(dy * 2 + 1, height - 1);
+        for (int dx = 0; dx < result.width; ++dx) {
+            int sx0 = std::min(dx * 2, width - 1);
+            int sx1 = std::min(dx * 2 + 1, width - 1);
+            const uint8_t* p00 = &pixels[(static_cast<size_t>(sy0) * width + sx0) * 4];
+            const uint8_t* p01 = &pixels[(static_cast<size_t>(sy0) * width + sx1) * 4];
+            const uint8_t* p10 = &pixels[(static_cast<size_t>(sy1) * width + sx0) * 4];
+            const uint8_t* p11 = &pixels[(static_cast<size_t>(sy1) * width + sx1) * 4];
+            uint8_t* out = &result.pixels[(static_cast<size_t>(dy) * result.width + dx) * 4];
+            for (int c = 0; c < 3; ++c) {
+                out[c] = linearToSrgb((toLinear[p00[c]] + toLinear[p01[c]] + toLinear[p10[c]] + toLinear[p11[c]]) * 0.25f);
+            }
+            out[3] = static_cast<uint8_t>((p00[3] + p01[3] + p10[3] + p11[3] + 2) / 4);
+        }
+    }
+    return result;
+}
+
+std::vector<ImageData> ImageData::buildMipChain() const {
+    std::vector<ImageData> levels;
+    levels.push_back(*this);
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        levels.push_back(levels.back().halfSize());
+    }
+    return levels;
+}
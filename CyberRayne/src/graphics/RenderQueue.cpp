@@ -0,0 +1,74 @@
+#include "../../include/RenderQueue.h"
+#include <cstring>
+
+const char* renderLayerName(RenderLayer layer) {
+    switch (layer) {
+    case RenderLayer::Background: return "background";
+    case RenderLayer::Tiles: return "tiles";
+    case RenderLayer::Entities: return "entities";
+    case RenderLayer::UI: return "ui";
+    default: return "unknown";
+    }
+}
+
+LayerOrdering renderLayerOrdering(RenderLayer layer) {
+    switch (layer) {
+    case RenderLayer::Tiles: return LayerOrdering::ByTexture;
+    case RenderLayer::Entities: return LayerOrdering::YSorted;
+    default: return LayerOrdering::Submission;
+    }
+}
+
+bool renderLayerUsesCamera(RenderLayer layer) {
+    return layer == RenderLayer::Tiles || layer == RenderLayer::Entities;
+}
+
+uint64_t RenderQueue::makeKey(RenderLayer layer, uint32_t depth, uint32_t blendMode, uint32_t texture) {
+    return (static_cast<uint64_t>(layer) << 56) |
+           (static_cast<uint64_t>(depth) << 24) |
+           (static_cast<uint64_t>(blendMode & 0xF) << 20) |
+           static_cast<uint64_t>(texture & 0xFFFFF);
+}
+
+uint32_t RenderQueue::depthFromFloat(float depth) {
+    // IEEE floats sort like sign-magnitude integers: flip all bits of negatives, only the sign of positives
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+void RenderQueue::sort() {
+    const size_t count = m_entries.size();
+    if (count < 2) {
+        return;
+    }
+
+    // Bytes that differ anywhere are the only ones worth a pass
+    uint64_t first = m_entries[0].key;
+    uint64_t differing = 0;
+    for (const Entry& entry : m_entries) {
+        differing |= entry.key ^ first;
+    }
+
+    m_scratch.resize(count);
+    for (int shift = 0; shift < 64; shift += 8) {
+        if (((differing >> shift) & 0xFF) == 0) {
+            continue;
+        }
+
+        size_t offsets[256] = {};
+        for (const Entry& entry : m_entries) {
+            ++offsets[(entry.key >> shift) & 0xFF];
+        }
+        size_t total = 0;
+        for (size_t& offset : offsets) {
+            size_t bucketCount = offset;
+            offset = total;
+            total += bucketCount;
+        }
+        for (const Entry& entry : m_entries) {
+            m_scratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        m_entries.swap(m_scratch);
+    }
+}
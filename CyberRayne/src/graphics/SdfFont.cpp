@@ -0,0 +1,142 @@
+#include "../../include/SdfFont.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Classic 5x7 LCD font for ' ' to '~': five columns per glyph, bit 0 is the top row
+const uint8_t FONT_5X7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, // ' ' ! "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // # $ %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00}, // & ' (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // ) * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // / 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10}, // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, // 8 9 :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E}, // > ? @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // A B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01}, // D E F
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // G H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40}, // J K L
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // M N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, // P Q R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // S T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63}, // V W X
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // _ ` a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F}, // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x14, 0x54, 0x54, 0x3C}, // e f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, // h i j
+    {0x00, 0x7F, 0x10, 0x28, 0x44}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, // k l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08}, // n o p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // q r s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, // t u v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, // w x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00}, // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},                                 // } ~
+};
+static_assert(sizeof(FONT_5X7) / sizeof(FONT_5X7[0]) == '~' - ' ' + 1, "one glyph per printable ASCII character");
+
+bool isSet(int glyph, int column, int row) {
+    if (column < 0 || column >= SdfFont::GLYPH_COLUMNS || row < 0 || row >= SdfFont::GLYPH_ROWS) {
+        return false;
+    }
+    return (FONT_5X7[glyph][column] >> row) & 1;
+}
+
+// Distance from (x, y) to the unit square at (column, row)
+float distanceToCell(float x, float y, int column, int row) {
+    float dx = std::max({static_cast<float>(column) - x, 0.0f, x - static_cast<float>(column + 1)});
+    float dy = std::max({static_cast<float>(row) - y, 0.0f, y - static_cast<float>(row + 1)});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+SdfFont::SdfFont(int texelsPerUnit)
+    : m_texelsPerUnit(std::max(1, texelsPerUnit)),
+      m_cellWidth((GLYPH_COLUMNS + 2 * CELL_PADDING) * m_texelsPerUnit),
+      m_cellHeight((GLYPH_ROWS + 2 * CELL_PADDING) * m_texelsPerUnit) {
+    buildAtlas();
+}
+
+void SdfFont::buildAtlas() {
+    const int glyphCount = LAST_CHAR - FIRST_CHAR + 1;
+    const int atlasRows = (glyphCount + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    m_atlas.width = ATLAS_COLUMNS * m_cellWidth;
+    m_atlas.height = atlasRows * m_cellHeight;
+    m_atlas.pixels.assign(static_cast<size_t>(m_atlas.width) * m_atlas.height * 4, 0);
+    for (int glyph = 0; glyph < glyphCount; ++glyph) {
+        buildGlyph(glyph, (glyph % ATLAS_COLUMNS) * m_cellWidth, (glyph / ATLAS_COLUMNS) * m_cellHeight);
+    }
+}
+
+void SdfFont::buildGlyph(int glyph, int cellX, int cellY) {
+    // The glyph is a union of unit squares, so the exact distance to its outline is the distance to
+    // the nearest square of the other kind. Squares outside the 5x7 grid are empty; beyond one unit
+    // of padding the distance saturates anyway.
+    for (int ty = 0; ty < m_cellHeight; ++ty) {
+        for (int tx = 0; tx < m_cellWidth; ++tx) {
+            float x = (tx + 0.5f) / m_texelsPerUnit - CELL_PADDING;
+            float y = (ty + 0.5f) / m_texelsPerUnit - CELL_PADDING;
+            bool inside = isSet(glyph, static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)));
+
+            float nearest = DISTANCE_SPREAD;
+            for (int row = -CELL_PADDING; row < GLYPH_ROWS + CELL_PADDING; ++row) {
+                for (int column = -CELL_PADDING; column < GLYPH_COLUMNS + CELL_PADDING; ++column) {
+                    if (isSet(glyph, column, row) != inside) {
+                        nearest = std::min(nearest, distanceToCell(x, y, column, row));
+                    }
+                }
+            }
+
+            float signedDistance = inside ? nearest : -nearest;
+            float value = 0.5f + 0.5f * signedDistance / DISTANCE_SPREAD;
+            uint8_t* texel = &m_atlas.pixels[(static_cast<size_t>(cellY + ty) * m_atlas.width + cellX + tx) * 4];
+            texel[0] = texel[1] = texel[2] = 255;
+            texel[3] = static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+    }
+}
+
+SdfFont::TextLayout SdfFont::layout(const std::string& text) const {
+    TextLayout result;
+    float penX = 0.0f;
+    float penY = 0.0f;
+    int lines = 1;
+    for (char c : text) {
+        if (c == '\n') {
+            result.width = std::max(result.width, penX - (ADVANCE - GLYPH_COLUMNS));
+            penX = 0.0f;
+            penY += LINE_HEIGHT;
+            ++lines;
+            continue;
+        }
+        if (c < FIRST_CHAR || c > LAST_CHAR) {
+            c = '?';
+        }
+        if (c != ' ') {
+            int glyph = c - FIRST_CHAR;
+            float u0 = static_cast<float>((glyph % ATLAS_COLUMNS) * m_cellWidth) / m_atlas.width;
+            float v0 = static_cast<float>((glyph / ATLAS_COLUMNS) * m_cellHeight) / m_atlas.height;
+            GlyphQuad quad;
+            quad.x = penX - CELL_PADDING;
+            quad.y = penY - CELL_PADDING;
+            quad.width = static_cast<float>(GLYPH_COLUMNS + 2 * CELL_PADDING);
+            quad.height = static_cast<float>(GLYPH_ROWS + 2 * CELL_PADDING);
+            quad.uvRect[0] = u0;
+            quad.uvRect[1] = v0;
+            quad.uvRect[2] = u0 + static_cast<float>(m_cellWidth) / m_atlas.width;
+            quad.uvRect[3] = v0 + static_cast<float>(m_cellHeight) / m_atlas.height;
+            result.glyphs.push_back(quad);
+        }
+        penX += ADVANCE;
+    }
+    result.width = std::max(result.width, penX - (ADVANCE - GLYPH_COLUMNS));
+    result.height = static_cast<float>(lines * GLYPH_ROWS + (lines - 1) * (LINE_HEIGHT - GLYPH_ROWS));
+    return result;
+}
@@ -0,0 +1,131 @@
+#include "../../include/SpriteAnimation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+float AnimationClip::duration() const {
+    float total = 0.0f;
+    for (const AnimationFrame& frame : frames) {
+        total += frame.duration;
+    }
+    return total;
+}
+
+std::vector<AnimationFrame> gridAnimationFrames(int columns, int rows, int firstCell, int count, float frameDuration) {
+    std::vector<AnimationFrame> frames;
+    if (columns <= 0 || rows <= 0) {
+        return frames;
+    }
+    const float cellWidth = 1.0f / static_cast<float>(columns);
+    const float cellHeight = 1.0f / static_cast<float>(rows);
+    for (int cell = firstCell; cell < firstCell + count && cell < columns * rows; ++cell) {
+        const float u = static_cast<float>(cell % columns) * cellWidth;
+        const float v = static_cast<float>(cell / columns) * cellHeight;
+        frames.push_back({{u, v, u + cellWidth, v + cellHeight}, frameDuration});
+    }
+    return frames;
+}
+
+int selectAnimationFrame(const AnimationClip& clip, float time) {
+    const float total = clip.duration();
+    if (clip.frames.empty() || total <= 0.0f) {
+        return 0;
+    }
+
+    // Same steps as the vertex shader, so CPU and GPU agree on the frame
+    float t = std::max(time, 0.0f);
+    if (clip.loop == AnimationLoop::Loop) {
+        t = t - total * std::floor(t / total);
+    } else if (clip.loop == AnimationLoop::PingPong) {
+        t = t - 2.0f * total * std::floor(t / (2.0f * total));
+        if (t > total) {
+            t = 2.0f * total - t;
+        }
+    }
+
+    float end = 0.0f;
+    for (size_t i = 0; i < clip.frames.size(); ++i) {
+        end += clip.frames[i].duration;
+        if (t < end) {
+            return static_cast<int>(i);
+        }
+    }
+    return static_cast<int>(clip.frames.size() - 1);
+}
+
+int selectPackedAnimationFrame(const std::vector<float>& table, uint32_t clip, float time) {
+    auto bitsAt = [&table](size_t word) {
+        uint32_t bits;
+        std::memcpy(&bits, &table[word], sizeof(bits));
+        return bits;
+    };
+    if ((static_cast<size_t>(clip) + 1) * 4 > table.size()) {
+        return 0;
+    }
+
+    // animatedUvRect() in vertex_shader.vert, step for step
+    const uint32_t first = bitsAt(clip * 4 + 0);
+    const uint32_t count = bitsAt(clip * 4 + 1);
+    const uint32_t loop = bitsAt(clip * 4 + 2);
+    const uint32_t durationBits = bitsAt(clip * 4 + 3);
+    float duration;
+    std::memcpy(&duration, &durationBits, sizeof(duration));
+    if (count == 0 || duration <= 0.0f) {
+        return 0;
+    }
+
+    float t = std::max(time, 0.0f);
+    if (loop == static_cast<uint32_t>(AnimationLoop::Loop)) {
+        t = t - duration * std::floor(t / duration);
+    } else if (loop == static_cast<uint32_t>(AnimationLoop::PingPong)) {
+        t = t - 2.0f * duration * std::floor(t / (2.0f * duration));
+        t = t > duration ? 2.0f * duration - t : t;
+    }
+
+    uint32_t frame = count - 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (t < table[(static_cast<size_t>(first) + i * 2 + 1) * 4]) {
+            frame = i;
+            break;
+        }
+    }
+    return static_cast<int>(frame);
+}
+
+size_t animationTableVec4Count(const std::vector<AnimationClip>& clips) {
+    size_t count = clips.size();
+    for (const AnimationClip& clip : clips) {
+        count += clip.frames.size() * 2;
+    }
+    return count;
+}
+
+void packAnimationTable(const std::vector<AnimationClip>& clips, std::vector<float>& table, const AnimationUVRemap& remapUV) {
+    table.assign(animationTableVec4Count(clips) * 4, 0.0f);
+    auto storeBits = [&table](size_t word, uint32_t bits) { std::memcpy(&table[word], &bits, sizeof(bits)); };
+
+    size_t nextFrame = clips.size();
+    for (size_t c = 0; c < clips.size(); ++c) {
+        const AnimationClip& clip = clips[c];
+        const float duration = clip.duration();
+        uint32_t durationBits;
+        std::memcpy(&durationBits, &duration, sizeof(durationBits));
+        storeBits(c * 4 + 0, static_cast<uint32_t>(nextFrame));
+        storeBits(c * 4 + 1, static_cast<uint32_t>(clip.frames.size()));
+        storeBits(c * 4 + 2, static_cast<uint32_t>(clip.loop));
+        storeBits(c * 4 + 3, durationBits);
+
+        float end = 0.0f;
+        for (const AnimationFrame& frame : clip.frames) {
+            float* uv = &table[nextFrame * 4];
+            if (remapUV) {
+                remapUV(clip, frame.uvRect, uv);
+            } else {
+                std::copy(frame.uvRect, frame.uvRect + 4, uv);
+            }
+            end += frame.duration;
+            table[nextFrame * 4 + 4] = end;
+            nextFrame += 2;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "../../include/TextRenderer.h"
+#include "../../include/VulkanRenderer.h"
+#include <iostream>
+
+TextRenderer::TextRenderer() : m_fontTexture(-1) {}
+
+TextRenderer::~TextRenderer() {}
+
+void TextRenderer::initialize(VulkanRenderer* renderer) {
+    if (m_fontTexture >= 0) {
+        return;
+    }
+    if (!m_font) {
+        m_font = std::make_unique<SdfFont>();
+    }
+    m_fontTexture = renderer->loadTextureFromImage(m_font->getAtlas());
+    if (m_fontTexture < 0) {
+        std::cerr << "Text renderer: failed to upload the font atlas, text is disabled" << std::endl;
+        return;
+    }
+    std::cout << "Text renderer ready (SDF font atlas " << m_font->getAtlas().width << "x"
+              << m_font->getAtlas().height << ")" << std::endl;
+}
+
+void TextRenderer::release(VulkanRenderer* renderer) {
+    if (m_fontTexture >= 0) {
+        renderer->releaseTexture(m_fontTexture);
+    }
+    m_fontTexture = -1;
+}
+
+const SdfFont::TextLayout& TextRenderer::getLayout(const std::string& text) {
+    auto it = m_layoutCache.find(text);
+    if (it != m_layoutCache.end()) {
+        return it->second;
+    }
+    if (m_layoutCache.size() >= MAX_CACHED_LAYOUTS) {
+        m_layoutCache.clear();
+    }
+    return m_layoutCache.emplace(text, m_font->layout(text)).first->second;
+}
+
+void TextRenderer::drawText(VulkanRenderer* renderer, const std::string& text, float leftPx, float topPx,
+                            float pixelHeight, const float color[4]) {
+    const VkExtent2D extent = renderer->getSwapchainExtent();
+    m_scratch.clear();
+    appendText(m_scratch, text, leftPx, topPx, pixelHeight, color, static_cast<float>(extent.width), static_cast<float>(extent.height));
+    for (const SpriteInstance& instance : m_scratch) {
+        renderer->renderSpriteInstance(instance);
+    }
+}
+
+void TextRenderer::appendText(std::vector<SpriteInstance>& out, const std::string& text, float leftPx, float topPx,
+                              float pixelHeight, const float color[4], float screenWidth, float screenHeight) {
+    if (m_fontTexture < 0 || text.empty() || screenWidth <= 0.0f || screenHeight <= 0.0f) {
+        return;
+    }
+
+    // Font units -> pixels -> NDC (the unit quad is centred, NDC +y is down)
+    const float unitPx = pixelHeight / SdfFont::GLYPH_ROWS;
+    const float toNdcX = 2.0f / screenWidth;
+    const float toNdcY = 2.0f / screenHeight;
+    for (const SdfFont::GlyphQuad& quad : getLayout(text).glyphs) {
+        SpriteInstance instance{};
+        instance.size[0] = quad.width * unitPx * toNdcX;
+        instance.size[1] = quad.height * unitPx * toNdcY;
+        instance.position[0] = -1.0f + (leftPx + quad.x * unitPx) * toNdcX + instance.size[0] * 0.5f;
+        instance.position[1] = -1.0f + (topPx + quad.y * unitPx) * toNdcY + instance.size[1] * 0.5f;
+        for (int i = 0; i < 4; ++i) {
+            instance.uvRect[i] = quad.uvRect[i];
+            instance.tint[i] = color[i];
+        }
+        instance.textureIndex = m_fontTexture | SPRITE_DISTANCE_FIELD_FLAG;
+        out.push_back(instance);
+    }
+}
+
+void TextRenderer::measureText(const std::string& text, float pixelHeight, float& widthPx, float& heightPx) {
+    widthPx = heightPx = 0.0f;
+    if (!m_font) {
+        return;
+    }
+    const SdfFont::TextLayout& layout = getLayout(text);
+    const float unitPx = pixelHeight / SdfFont::GLYPH_ROWS;
+    widthPx = layout.width * unitPx;
+    heightPx = layout.height * unitPx;
+}
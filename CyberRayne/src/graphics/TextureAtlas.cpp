@@ -0,0 +1,156 @@
+#include "../../include/TextureAtlas.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <climits>
+
+TextureAtlas::TextureAtlas(int maxPageSize, int padding)
+    : m_maxPageSize(std::max(1, maxPageSize)),
+      m_padding(std::max(0, padding)) {
+}
+
+TextureAtlas::Page TextureAtlas::createPage(int pageWidth) const {
+    Page page;
+    page.width = pageWidth;
+    page.height = m_maxPageSize;
+    page.skyline.push_back({0, 0, pageWidth});
+    return page;
+}
+
+bool TextureAtlas::findPosition(const Page& page, int width, int height, int& bestX, int& bestY, size_t& bestNode) {
+    bestY = INT_MAX;
+    bestX = INT_MAX;
+    bool found = false;
+
+    for (size_t i = 0; i < page.skyline.size(); ++i) {
+        int x = page.skyline[i].x;
+        if (x + width > page.width) {
+            break;
+        }
+
+        // The rectangle rests on the highest skyline segment it spans
+        int y = 0;
+        int remaining = width;
+        for (size_t j = i; j < page.skyline.size() && remaining > 0; ++j) {
+            y = std::max(y, page.skyline[j].y);
+            remaining -= page.skyline[j].width;
+        }
+        if (y + height > page.height) {
+            continue;
+        }
+
+        // Bottom-left rule: lowest position first, then leftmost
+        if (y < bestY || (y == bestY && x < bestX)) {
+            bestX = x;
+            bestY = y;
+            bestNode = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void TextureAtlas::addSkylineLevel(Page& page, size_t nodeIndex, int x, int y, int width, int height) {
+    SkylineNode newNode{x, y + height, width};
+    page.skyline.insert(page.skyline.begin() + nodeIndex, newNode);
+
+    // Shrink or remove the segments now covered by the new node
+    for (size_t i = nodeIndex + 1; i < page.skyline.size(); ) {
+        SkylineNode& prev = page.skyline[i - 1];
+        SkylineNode& node = page.skyline[i];
+        int prevEnd = prev.x + prev.width;
+        if (node.x >= prevEnd) {
+            break;
+        }
+        int shrink = prevEnd - node.x;
+        node.x += shrink;
+        node.width -= shrink;
+        if (node.width <= 0) {
+            page.skyline.erase(page.skyline.begin() + i);
+        } else {
+            break;
+        }
+    }
+
+    // Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < page.skyline.size(); ) {
+        if (page.skyline[i].y == page.skyline[i + 1].y) {
+            page.skyline[i].width += page.skyline[i + 1].width;
+            page.skyline.erase(page.skyline.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+}
+
+std::vector<TextureAtlas::Placement> TextureAtlas::pack(const std::vector<PageSize>& sizes) {
+    std::vector<Placement> placements(sizes.size());
+    m_pages.clear();
+    if (sizes.empty()) {
+        return placements;
+    }
+
+    // Tallest first gives the skyline a flat profile to build on
+    std::vector<size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (sizes[a].height != sizes[b].height) return sizes[a].height > sizes[b].height;
+        return sizes[a].width > sizes[b].width;
+    });
+
+    // Pick a page width close to square for the total area, so small sets don't get a huge page
+    double totalArea = 0.0;
+    int widest = 1;
+    for (const auto& size : sizes) {
+        int w = size.width + 2 * m_padding;
+        int h = size.height + 2 * m_padding;
+        totalArea += static_cast<double>(w) * static_cast<double>(h);
+        widest = std::max(widest, w);
+    }
+    int pageWidth = 1;
+    while (pageWidth < static_cast<int>(std::ceil(std::sqrt(totalArea))) && pageWidth < m_maxPageSize) {
+        pageWidth *= 2;
+    }
+    pageWidth = std::min(m_maxPageSize, std::max(pageWidth, widest));
+
+    std::vector<Page> pages;
+    for (size_t index : order) {
+        int w = sizes[index].width + 2 * m_padding;
+        int h = sizes[index].height + 2 * m_padding;
+        if (w > m_maxPageSize || h > m_maxPageSize || sizes[index].width <= 0 || sizes[index].height <= 0) {
+            continue; // Caller must scale oversized entries down; leave page = -1
+        }
+
+        int x = 0, y = 0;
+        size_t node = 0;
+        int pageIndex = -1;
+        for (size_t p = 0; p < pages.size(); ++p) {
+            if (findPosition(pages[p], w, h, x, y, node)) {
+                pageIndex = static_cast<int>(p);
+                break;
+            }
+        }
+        if (pageIndex < 0) {
+            pages.push_back(createPage(pageWidth));
+            pageIndex = static_cast<int>(pages.size() - 1);
+            findPosition(pages.back(), w, h, x, y, node);
+        }
+
+        Page& page = pages[pageIndex];
+        addSkylineLevel(page, node, x, y, w, h);
+        page.usedWidth = std::max(page.usedWidth, x + w);
+        page.usedHeight = std::max(page.usedHeight, y + h);
+
+        Placement& placement = placements[index];
+        placement.page = pageIndex;
+        placement.x = x + m_padding;
+        placement.y = y + m_padding;
+        placement.width = sizes[index].width;
+        placement.height = sizes[index].height;
+    }
+
+    for (const auto& page : pages) {
+        m_pages.push_back({page.usedWidth, page.usedHeight});
+    }
+    return placements;
+}
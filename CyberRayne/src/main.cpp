@@ -2,6 +2,10 @@
 #include <iostream>
 #include <memory>
 #include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 int main(int argc, char* argv[]) {
     std::cout << "Starting FF9-style JRPG..." << std::endl;
@@ -9,6 +13,15 @@ int main(int argc, char* argv[]) {
     // Parse command line arguments
     bool benchmarkMode = false;
     int maxFrames = 500;  // Default benchmark frames
+    bool framesSet = false;
+    bool headless = false;
+    std::vector<int> captureFrames;
+    std::string captureDir = ".";
+    std::string presentMode;
+    int framesInFlight = 0;
+    int frameRateCap = 60;
+    float renderScale = 1.0f;
+    bool reactive = true;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--benchmark") == 0) {
@@ -16,21 +29,66 @@ int main(int argc, char* argv[]) {
             std::cout << "Benchmark mode enabled" << std::endl;
         } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
             maxFrames = std::atoi(argv[++i]);
+            framesSet = true;
             std::cout << "Max frames set to: " << maxFrames << std::endl;
         } else if (strncmp(argv[i], "--frames=", 9) == 0) {
             maxFrames = std::atoi(argv[i] + 9);
+            framesSet = true;
             std::cout << "Max frames set to: " << maxFrames << std::endl;
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+            std::cout << "Headless mode enabled" << std::endl;
+        } else if (strcmp(argv[i], "--capture-frame") == 0 && i + 1 < argc) {
+            captureFrames.push_back(std::atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--capture-dir") == 0 && i + 1 < argc) {
+            captureDir = argv[++i];
+        } else if (strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc) {
+            presentMode = argv[++i];
+            std::cout << "Present mode set to: " << presentMode << std::endl;
+        } else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) {
+            framesInFlight = std::atoi(argv[++i]);
+            std::cout << "Frames in flight set to: " << framesInFlight << std::endl;
+        } else if (strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc) {
+            frameRateCap = std::atoi(argv[++i]);
+            std::cout << "Frame rate cap set to: " << frameRateCap << (frameRateCap > 0 ? "" : " (uncapped)") << std::endl;
+        } else if (strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+            renderScale = static_cast<float>(std::atof(argv[++i]));
+            std::cout << "Render scale set to: " << renderScale << std::endl;
+        } else if (strcmp(argv[i], "--no-reactive") == 0) {
+            reactive = false;
+            std::cout << "Reactive rendering disabled" << std::endl;
         }
     }
 
+    if (!captureFrames.empty() && !headless) {
+        std::cerr << "--capture-frame requires --headless, ignoring captures" << std::endl;
+        captureFrames.clear();
+    }
+    // Without a window nothing can close the game, so headless runs always stop after a frame count
+    // (by default just past the last captured frame)
+    if (headless && !benchmarkMode && !framesSet && !captureFrames.empty()) {
+        maxFrames = *std::max_element(captureFrames.begin(), captureFrames.end()) + 1;
+    }
+
     try {
         // Create and initialize the game
         std::unique_ptr<Game> game = std::make_unique<Game>();
         
         // Configure benchmark mode if enabled
-        if (benchmarkMode) {
+        if (benchmarkMode || headless) {
             game->setBenchmarkMode(true, maxFrames);
         }
+        game->setPresentMode(presentMode);
+        game->setFramesInFlight(framesInFlight);
+        game->setFrameRateCap(frameRateCap);
+        game->setRenderScale(renderScale);
+        game->setReactiveRendering(reactive);
+        if (headless) {
+            game->setHeadless(true);
+            for (int frame : captureFrames) {
+                game->requestFrameCapture(frame, captureDir + "/frame_" + std::to_string(frame) + ".ppm");
+            }
+        }
         
         if (!game->initialize()) {
             std::cerr << "Failed to initialize game!" << std::endl;
@@ -53,7 +111,7 @@ int main(int argc, char* argv[]) {
     }
 
     // Only pause in interactive mode
-    if (!benchmarkMode) {
+    if (!benchmarkMode && !headless) {
         std::cout << "Press Enter to exit..." << std::endl;
         std::cin.get();
     }
@@ -25,10 +25,18 @@ void BattleSystem::startBattle(const std::vector<std::unique_ptr<Enemy>>& enemie
         m_enemies.push_back(enemy.get());
     }
     
-    std::cout << "A battle has started!" << std::endl;
+    message("A battle has started!");
     displayBattleStatus();
 }
 
+void BattleSystem::message(const std::string& text) {
+    if (m_uiManager) {
+        m_uiManager->displayMessage(text);
+    } else {
+        std::cout << text << std::endl;
+    }
+}
+
 void BattleSystem::update() {
     if (m_battleResult != BattleResult::ONGOING) {
         return;
@@ -83,20 +91,19 @@ void BattleSystem::playerAttack() {
     Enemy* target = m_enemies[0];
     int damage = m_player->getStrength();
     
-    std::cout << m_player->getName() << " attacks " << target->getName() 
-              << " for " << damage << " damage!" << std::endl;
+    message(m_player->getName() + " attacks " + target->getName() + " for " + std::to_string(damage) + " damage!");
     
     target->takeDamage(damage);
     
     // Check if enemy is defeated
     if (target->getHealth() <= 0) {
-        std::cout << target->getName() << " is defeated!" << std::endl;
+        message(target->getName() + " is defeated!");
         // Remove defeated enemy
         m_enemies.erase(std::remove(m_enemies.begin(), m_enemies.end(), target), m_enemies.end());
         
         // Check for victory
         if (m_enemies.empty()) {
-            std::cout << "You win the battle!" << std::endl;
+            message("You win the battle!");
             m_battleResult = BattleResult::PLAYER_WIN;
         }
     }
@@ -104,26 +111,26 @@ void BattleSystem::playerAttack() {
 
 void BattleSystem::playerUseMagic(int spellIndex) {
     // Implementation would go here
-    std::cout << "Using magic is not yet implemented." << std::endl;
+    message("Using magic is not yet implemented.");
 }
 
 void BattleSystem::playerUseItem(int itemIndex) {
     // Implementation would go here
-    std::cout << "Using items is not yet implemented." << std::endl;
+    message("Using items is not yet implemented.");
 }
 
 void BattleSystem::playerDefend() {
     // Implementation would go here
-    std::cout << m_player->getName() << " takes a defensive stance." << std::endl;
+    message(m_player->getName() + " takes a defensive stance.");
 }
 
 void BattleSystem::playerFlee() {
     // Simple flee chance
     if (rand() % 2 == 0) {  // 50% chance to flee
-        std::cout << m_player->getName() << " successfully fled from battle!" << std::endl;
+        message(m_player->getName() + " successfully fled from battle!");
         m_battleResult = BattleResult::PLAYER_FLED;
     } else {
-        std::cout << m_player->getName() << " failed to flee!" << std::endl;
+        message(m_player->getName() + " failed to flee!");
     }
 }
 
@@ -136,14 +143,13 @@ void BattleSystem::enemyTurn() {
     Enemy* attacker = m_enemies[0];
     int damage = attacker->getStrength();
     
-    std::cout << attacker->getName() << " attacks " << m_player->getName() 
-              << " for " << damage << " damage!" << std::endl;
+    message(attacker->getName() + " attacks " + m_player->getName() + " for " + std::to_string(damage) + " damage!");
     
     m_player->takeDamage(damage);
     
     // Check if player is defeated
     if (m_player->getHealth() <= 0) {
-        std::cout << m_player->getName() << " has been defeated!" << std::endl;
+        message(m_player->getName() + " has been defeated!");
         m_battleResult = BattleResult::PLAYER_LOSE;
     }
 }
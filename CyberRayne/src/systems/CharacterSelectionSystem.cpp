@@ -22,9 +22,26 @@ bool CharacterSelectionSystem::initialize() {
 }
 
 #ifndef NO_VULKAN
+void CharacterSelectionSystem::releaseTextures(VulkanRenderer* renderer) {
+    if (!renderer) return;
+    
+    int* handles[] = { &m_backgroundTextureIndex, &m_selectionFrameTextureIndex, &m_cursorTextureIndex };
+    for (int* handle : handles) {
+        if (*handle >= 0) renderer->releaseTexture(*handle);
+        *handle = -1;
+    }
+    for (auto& option : m_characterOptions) {
+        if (option.textureIndex >= 0) renderer->releaseTexture(option.textureIndex);
+        option.textureIndex = -1;
+    }
+}
+
 void CharacterSelectionSystem::loadTextures(VulkanRenderer* renderer) {
     if (!renderer) return;
     
+    // Drop references from an earlier load before taking new ones
+    releaseTextures(renderer);
+    
     std::string base = renderer->getAssetsBasePath();
     
     // Load background (reuse menu background)
@@ -36,6 +53,10 @@ void CharacterSelectionSystem::loadTextures(VulkanRenderer* renderer) {
         std::cerr << "Character selection background not found: " << bgPath << std::endl;
     }
     
+    // Cursor and character portraits share an atlas; the full-screen background stays standalone.
+    // The portraits are large PNGs, so the batch is decoded and packed on a worker thread.
+    renderer->beginTextureAtlas(1024);
+    
     // Load cursor texture
     std::string cursorPath = base + "/ui/cursor.png";
     if (std::filesystem::exists(cursorPath)) {
@@ -54,14 +75,16 @@ void CharacterSelectionSystem::loadTextures(VulkanRenderer* renderer) {
     
     for (size_t i = 0; i < m_characterOptions.size() && i < charTextures.size(); ++i) {
         if (std::filesystem::exists(charTextures[i])) {
-            m_characterOptions[i].textureIndex = renderer->loadTexture(charTextures[i]);
-            std::cout << "Loaded character texture " << i << ": " << charTextures[i] 
+            m_characterOptions[i].textureIndex = renderer->loadTextureAsync(charTextures[i]);
+            std::cout << "Requested character texture " << i << ": " << charTextures[i] 
                       << " (index: " << m_characterOptions[i].textureIndex << ")" << std::endl;
         } else {
             m_characterOptions[i].textureIndex = -1;
             std::cerr << "Character texture not found: " << charTextures[i] << std::endl;
         }
     }
+    
+    renderer->endTextureAtlas();
 }
 #endif
 
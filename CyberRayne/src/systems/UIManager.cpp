@@ -13,8 +13,13 @@ UIManager::UIManager()
       m_selectedTargetIndex(0),
       m_selectedSpellIndex(0),
       m_cursorTextureIndex(-1),
-      m_backgroundTextureIndex(-1) {
+      m_backgroundTextureIndex(-1),
+      m_tree(&m_textRenderer),
+      m_cursorWidget(-1),
+      m_playerTextWidget(-1),
+      m_playerBarWidget(-1) {
     for(int i=0; i<4; ++i) m_buttonTextureIndices[i] = -1;
+    for(int i=0; i<4; ++i) m_buttonWidgets[i] = -1;
 }
 
 UIManager::~UIManager() {}
@@ -23,10 +28,36 @@ void UIManager::initialize(VulkanRenderer* renderer) {
     loadTextures(renderer);
 }
 
+void UIManager::releaseTextures(VulkanRenderer* renderer) {
+    m_tree.clear();
+    m_enemyWidgets.clear();
+    m_messageWidgets.clear();
+    m_playerTextWidget = -1;
+    if (renderer) {
+        m_textRenderer.release(renderer);
+        if (m_backgroundTextureIndex >= 0) renderer->releaseTexture(m_backgroundTextureIndex);
+        if (m_cursorTextureIndex >= 0) renderer->releaseTexture(m_cursorTextureIndex);
+        for (int i = 0; i < 4; ++i) {
+            if (m_buttonTextureIndices[i] >= 0) renderer->releaseTexture(m_buttonTextureIndices[i]);
+        }
+    }
+    m_backgroundTextureIndex = -1;
+    m_cursorTextureIndex = -1;
+    for (int i = 0; i < 4; ++i) {
+        m_buttonTextureIndices[i] = -1;
+    }
+}
+
 void UIManager::loadTextures(VulkanRenderer* renderer) {
+    // Drop references from an earlier load before taking new ones
+    releaseTextures(renderer);
+
     const std::string base = renderer->getAssetsBasePath();
     auto exists = [](const std::string& p){ return std::filesystem::exists(p); };
 
+    // Battle UI images share atlas pages
+    renderer->beginTextureAtlas();
+
     // Reuse menu assets for now
     std::string bgPath = base + "/ui/menu_background.png";
     if (exists(bgPath)) m_backgroundTextureIndex = renderer->loadTexture(bgPath);
@@ -49,81 +80,105 @@ void UIManager::loadTextures(VulkanRenderer* renderer) {
             m_buttonTextureIndices[i] = renderer->loadTexture(btnPaths[i]);
         }
     }
-}
 
-void UIManager::renderBattleUI(VulkanRenderer* renderer, Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies) {
-    // Render background (if we want a UI overlay background, otherwise battle scene is behind)
-    // For now, let's assume the battle scene is rendered by BattleSystem/World, 
-    // and we just render the UI on top.
-    
-    if (m_battleState != BattleMenuState::WAITING) {
-        renderBattleMenu(renderer);
-        renderCursor(renderer);
-    }
-    
-    renderStats(renderer, player, enemies);
+    renderer->endTextureAtlas();
+
+    // The font atlas is its own texture (distance field, never packed into the colour atlas)
+    m_textRenderer.initialize(renderer);
+
+    buildTree();
 }
 
-void UIManager::renderBattleMenu(VulkanRenderer* renderer) {
-    int screenW = static_cast<int>(renderer->getSwapchainExtent().width);
-    int screenH = static_cast<int>(renderer->getSwapchainExtent().height);
-    
-    int startX = 50;
-    int startY = screenH - BUTTON_HEIGHT * 2 - 50;
-    
-    // Render 4 main action buttons
+void UIManager::buildTree() {
+    m_tree.clear();
+    m_enemyWidgets.clear();
+    m_messageWidgets.clear();
+
+    // 4 main action buttons in a 2x2 grid, bottom left
     const char* labels[] = {"Attack", "Magic", "Item", "Defend"};
-    
-    for(int i=0; i<4; ++i) {
-        int x = startX + (i % 2) * (BUTTON_WIDTH + 20);
-        int y = startY + (i / 2) * (BUTTON_HEIGHT + 20);
-        
-        if (m_buttonTextureIndices[i] >= 0) {
-            renderer->renderSpritePixelsWithTexture(x, y, BUTTON_WIDTH, BUTTON_HEIGHT, m_buttonTextureIndices[i]);
-        } else {
-            // Fallback colored rect
-            // renderer->renderSpritePixels(x, y, BUTTON_WIDTH, BUTTON_HEIGHT, 0.2f, 0.2f, 0.8f, 1.0f);
-        }
+    const float startY = -(BUTTON_HEIGHT * 2.0f + 50.0f);
+    for (int i = 0; i < 4; ++i) {
+        UIRect rect = UIRect::pixels(0.0f, 1.0f, 50.0f + (i % 2) * (BUTTON_WIDTH + 20), startY + (i / 2) * (BUTTON_HEIGHT + 20),
+                                     static_cast<float>(BUTTON_WIDTH), static_cast<float>(BUTTON_HEIGHT));
+        m_buttonWidgets[i] = m_tree.addButton(rect, m_buttonTextureIndices[i], labels[i], TEXT_HEIGHT);
+    }
+
+    // Cursor left of the highlighted button, overlapping it slightly
+    m_cursorWidget = -1;
+    if (m_cursorTextureIndex >= 0) {
+        m_cursorWidget = m_tree.addCursor(m_cursorTextureIndex, 64.0f, -10.0f, m_buttonWidgets[m_menuIndex]);
     }
+
+    // Player HP (Bottom Right), right-aligned, with a bar underneath
+    const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const float barFill[4] = {0.3f, 0.9f, 0.4f, 1.0f};
+    const float barBack[4] = {0.1f, 0.1f, 0.1f, 0.8f};
+    m_playerTextWidget = m_tree.addText(UIRect::pixels(1.0f, 1.0f, -50.0f, -100.0f, 0.0f, 0.0f), "", TEXT_HEIGHT, white, 1.0f);
+    m_playerBarWidget = m_tree.addBar(UIRect::pixels(1.0f, 1.0f, -250.0f, -100.0f + TEXT_HEIGHT + 8.0f, 200.0f, 8.0f), barFill, barBack);
+
+    // Battle log above the action buttons, newest line at the bottom and brightest
+    const float bottom = -(BUTTON_HEIGHT * 2.0f + 80.0f);
+    for (size_t age = 0; age < MAX_MESSAGES; ++age) {
+        const float color[4] = {1.0f, 1.0f, 1.0f, 1.0f - 0.2f * static_cast<float>(age)};
+        float top = bottom - (age + 1) * TEXT_HEIGHT * 1.5f;
+        m_messageWidgets.push_back(m_tree.addText(UIRect::pixels(0.0f, 1.0f, 50.0f, top, 0.0f, 0.0f), "", TEXT_HEIGHT, color));
+    }
+    updateMessages();
 }
 
-void UIManager::renderCursor(VulkanRenderer* renderer) {
-    if (m_cursorTextureIndex < 0) return;
-    
-    int screenW = static_cast<int>(renderer->getSwapchainExtent().width);
-    int screenH = static_cast<int>(renderer->getSwapchainExtent().height);
-    int startX = 50;
-    int startY = screenH - BUTTON_HEIGHT * 2 - 50;
-    
-    int targetX = 0, targetY = 0;
-    
-    if (m_battleState == BattleMenuState::MAIN_MENU) {
-        targetX = startX + (m_menuIndex % 2) * (BUTTON_WIDTH + 20);
-        targetY = startY + (m_menuIndex / 2) * (BUTTON_HEIGHT + 20);
+void UIManager::renderBattleUI(VulkanRenderer* renderer, Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies) {
+    // The battle scene is rendered by BattleSystem/World; the UI goes on top.
+    // All of the setters below are no-ops unless the value changed, so a quiet frame re-bakes nothing.
+    if (m_playerTextWidget < 0) {
+        return;
     }
-    
-    // Offset cursor to left of target
-    int cursorSize = 64;
-    renderer->renderSpritePixelsWithTexture(targetX - cursorSize + 10, targetY + (BUTTON_HEIGHT - cursorSize)/2, cursorSize, cursorSize, m_cursorTextureIndex);
+
+    const bool menuVisible = m_battleState != BattleMenuState::WAITING;
+    for (int i = 0; i < 4; ++i) {
+        m_tree.setVisible(m_buttonWidgets[i], menuVisible);
+    }
+    m_tree.setVisible(m_cursorWidget, menuVisible && m_battleState == BattleMenuState::MAIN_MENU);
+
+    updateStats(player, enemies);
+    m_tree.render(renderer);
 }
 
-void UIManager::renderStats(VulkanRenderer* renderer, Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies) {
-    // Placeholder for text rendering (since we don't have font rendering yet)
-    // We could render health bars here using colored quads
-    
-    int screenW = static_cast<int>(renderer->getSwapchainExtent().width);
-    
-    // Player HP Bar (Bottom Right)
+void UIManager::updateStats(Player* player, const std::vector<std::unique_ptr<Enemy>>& enemies) {
+    // Player HP, red once below a quarter
     float playerHpPct = static_cast<float>(player->getHealth()) / player->getMaxHealth();
-    int barW = 300;
-    int barH = 30;
-    int barX = screenW - barW - 50;
-    int barY = static_cast<int>(renderer->getSwapchainExtent().height) - 100;
-    
-    // Background
-    // renderer->renderSpritePixels(barX, barY, barW, barH, 0.2f, 0.0f, 0.0f, 1.0f);
-    // Foreground
-    // renderer->renderSpritePixels(barX, barY, static_cast<int>(barW * playerHpPct), barH, 0.0f, 0.8f, 0.0f, 1.0f);
+    std::string playerText = player->getName() + "  HP " + std::to_string(player->getHealth()) + "/" + std::to_string(player->getMaxHealth());
+    const float playerColor[4] = {1.0f, playerHpPct < 0.25f ? 0.3f : 1.0f, playerHpPct < 0.25f ? 0.3f : 1.0f, 1.0f};
+    m_tree.setText(m_playerTextWidget, playerText);
+    m_tree.setColor(m_playerTextWidget, playerColor);
+    m_tree.setValue(m_playerBarWidget, playerHpPct);
+
+    // Enemies (Top Left), one row per living enemy
+    const float enemyColor[4] = {1.0f, 0.85f, 0.6f, 1.0f};
+    size_t row = 0;
+    for (const auto& enemy : enemies) {
+        if (enemy->getHealth() <= 0) {
+            continue;
+        }
+        if (row == m_enemyWidgets.size()) {
+            float y = 40.0f + row * TEXT_HEIGHT * 1.6f;
+            m_enemyWidgets.push_back(m_tree.addText(UIRect::pixels(0.0f, 0.0f, 50.0f, y, 0.0f, 0.0f), "", TEXT_HEIGHT, enemyColor));
+        }
+        std::string enemyText = enemy->getName() + "  HP " + std::to_string(enemy->getHealth()) + "/" + std::to_string(enemy->getMaxHealth());
+        m_tree.setText(m_enemyWidgets[row], enemyText);
+        m_tree.setVisible(m_enemyWidgets[row], true);
+        ++row;
+    }
+    for (; row < m_enemyWidgets.size(); ++row) {
+        m_tree.setVisible(m_enemyWidgets[row], false);
+    }
+}
+
+void UIManager::updateMessages() {
+    for (size_t age = 0; age < m_messageWidgets.size(); ++age) {
+        bool shown = age < m_messages.size();
+        m_tree.setText(m_messageWidgets[age], shown ? m_messages[m_messages.size() - 1 - age] : std::string());
+        m_tree.setVisible(m_messageWidgets[age], shown);
+    }
 }
 
 void UIManager::handleInput(int key) {
@@ -152,6 +207,7 @@ void UIManager::handleInput(int key) {
                 // TODO: Magic/Item submenus
                 break;
         }
+        m_tree.setCursorTarget(m_cursorWidget, m_buttonWidgets[m_menuIndex]);
     }
 }
 
@@ -162,4 +218,9 @@ void UIManager::resetAction() {
 
 void UIManager::displayMessage(const std::string& message) {
     std::cout << "[UI] " << message << std::endl;
+    m_messages.push_back(message);
+    while (m_messages.size() > MAX_MESSAGES) {
+        m_messages.pop_front();
+    }
+    updateMessages();
 }
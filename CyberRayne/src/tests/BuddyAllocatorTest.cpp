@@ -0,0 +1,61 @@
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../../include/BuddyAllocator.h"
+#include "TestRunner.h"
+
+static bool testAlignmentAndMerge() {
+    BuddyAllocator allocator(1024, 64);
+    uint64_t a = 0, b = 0, c = 0;
+    // 100 bytes rounds to 128; a 512-byte alignment forces a 512-byte block
+    bool ok = allocator.allocate(100, 1, a) && allocator.allocate(16, 512, b) && allocator.allocate(64, 64, c);
+    ok = ok && a % 128 == 0 && b % 512 == 0 && c % 64 == 0 && allocator.getUsed() == 128 + 512 + 64;
+    uint64_t tooBig = 0;
+    ok = ok && !allocator.allocate(512, 1, tooBig);
+
+    allocator.free(a);
+    allocator.free(b);
+    allocator.free(c);
+    ok = ok && allocator.isEmpty() && allocator.getUsed() == 0 && allocator.getLargestFreeBlock() == 1024;
+    return ok;
+}
+
+static bool testRandomNoOverlap() {
+    struct Range { uint64_t offset, size; };
+    BuddyAllocator allocator(1 << 20, 256);
+    std::mt19937 rng(42);
+    std::vector<Range> live;
+    bool ok = true;
+    for (int i = 0; i < 4000 && ok; ++i) {
+        if (!live.empty() && rng() % 3 == 0) {
+            size_t index = rng() % live.size();
+            allocator.free(live[index].offset);
+            live.erase(live.begin() + index);
+            continue;
+        }
+        uint64_t size = 1 + rng() % 20000;
+        uint64_t offset = 0;
+        if (!allocator.allocate(size, 256, offset)) {
+            continue;
+        }
+        ok = offset % 256 == 0 && offset + size <= allocator.getSize();
+        for (const Range& range : live) {
+            ok = ok && (offset + size <= range.offset || range.offset + range.size <= offset);
+        }
+        live.push_back({offset, size});
+    }
+    for (const Range& range : live) {
+        allocator.free(range.offset);
+    }
+    // Everything merges back into one block
+    ok = ok && allocator.isEmpty() && allocator.getLargestFreeBlock() == allocator.getSize();
+    return ok;
+}
+
+int main() {
+    return runTests("Buddy Allocator", {
+        {"Alignment and merge", testAlignmentAndMerge},
+        {"Random allocations don't overlap", testRandomNoOverlap}
+    });
+}
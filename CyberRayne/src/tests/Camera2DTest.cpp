@@ -0,0 +1,110 @@
+#include <cmath>
+#include <iostream>
+#include "../../include/Camera2D.h"
+#include "TestRunner.h"
+
+static bool near(float a, float b, float epsilon = 1e-4f) {
+    return std::fabs(a - b) <= epsilon;
+}
+
+// What the vertex shader does with a world position: proj * view * p
+static void toNdc(const Camera2D& camera, float x, float y, float& ndcX, float& ndcY) {
+    float view[16], proj[16];
+    camera.getViewMatrix(view);
+    camera.getProjectionMatrix(proj);
+    const float viewX = view[0] * x + view[4] * y + view[12];
+    const float viewY = view[1] * x + view[5] * y + view[13];
+    ndcX = proj[0] * viewX + proj[4] * viewY + proj[12];
+    ndcY = proj[1] * viewX + proj[5] * viewY + proj[13];
+}
+
+static bool testProjection() {
+    Camera2D camera;
+    camera.setViewportSize(1920.0f, 1080.0f);
+    camera.setViewHeight(15.0f);
+    camera.setPosition(10.0f, 7.5f);
+
+    // 15 units high at 16:9 is 26.67 wide, and the visible rect maps onto the whole of NDC
+    float rect[4];
+    camera.getVisibleRect(rect);
+    bool ok = near(camera.getVisibleWidth(), 15.0f * 1920.0f / 1080.0f) && near(rect[1], 0.0f) && near(rect[3], 15.0f);
+    float x, y;
+    toNdc(camera, rect[0], rect[1], x, y);
+    ok = ok && near(x, -1.0f) && near(y, -1.0f);
+    toNdc(camera, rect[2], rect[3], x, y);
+    ok = ok && near(x, 1.0f) && near(y, 1.0f);
+    toNdc(camera, 10.0f, 7.5f, x, y);
+    ok = ok && near(x, 0.0f) && near(y, 0.0f);
+
+    // Zooming in halves what is visible; a square window shows as much across as down
+    camera.setZoom(2.0f);
+    ok = ok && near(camera.getVisibleHeight(), 7.5f);
+    camera.setViewportSize(600.0f, 600.0f);
+    ok = ok && near(camera.getVisibleWidth(), camera.getVisibleHeight());
+    return ok;
+}
+
+static bool testBounds() {
+    Camera2D camera;
+    camera.setViewportSize(1500.0f, 1500.0f);
+    camera.setViewHeight(15.0f);
+    camera.setBounds(0.0f, 0.0f, 40.0f, 30.0f);
+
+    // Near a corner the view stops at the map edge instead of showing past it
+    float x, y;
+    camera.setPosition(1.0f, 2.0f);
+    camera.getCenter(x, y);
+    bool ok = near(x, 7.5f) && near(y, 7.5f);
+    camera.setPosition(39.0f, 29.0f);
+    camera.getCenter(x, y);
+    ok = ok && near(x, 32.5f) && near(y, 22.5f);
+
+    // A map smaller than the view is centred
+    camera.setBounds(0.0f, 0.0f, 10.0f, 10.0f);
+    camera.getCenter(x, y);
+    ok = ok && near(x, 5.0f) && near(y, 5.0f);
+
+    // Centres land on whole pixels (100 pixels per unit here)
+    camera.clearBounds();
+    camera.setPosition(3.004f, 3.006f);
+    camera.getCenter(x, y);
+    ok = ok && near(x, 3.0f) && near(y, 3.01f);
+    return ok;
+}
+
+static bool testFollow() {
+    // Without smoothing the camera is on its target after every update
+    Camera2D camera;
+    camera.follow(4.0f, 5.0f);
+    camera.update(1.0f / 60.0f);
+    float x, y;
+    camera.getCenter(x, y);
+    bool ok = near(x, 4.0f, 0.01f) && near(y, 5.0f, 0.01f);
+
+    // Smoothing covers the same distance in a second at 30 or 120 updates per second
+    Camera2D slow, fast;
+    slow.setSmoothing(0.25f);
+    fast.setSmoothing(0.25f);
+    slow.follow(10.0f, 0.0f);
+    fast.follow(10.0f, 0.0f);
+    for (int i = 0; i < 30; ++i) {
+        slow.update(1.0f / 30.0f);
+    }
+    for (int i = 0; i < 120; ++i) {
+        fast.update(1.0f / 120.0f);
+    }
+    float slowX, fastX;
+    slow.getCenter(slowX, y);
+    fast.getCenter(fastX, y);
+    const float expected = 10.0f * (1.0f - std::exp(-4.0f));
+    ok = ok && near(slowX, expected, 0.02f) && near(fastX, expected, 0.02f);
+    return ok;
+}
+
+int main() {
+    return runTests("Camera", {
+        {"Projection", testProjection},
+        {"Bounds", testBounds},
+        {"Follow", testFollow}
+    });
+}
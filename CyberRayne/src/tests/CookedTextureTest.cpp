@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include "../../include/CookedTexture.h"
+#include "TestRunner.h"
+
+static ImageData makeCheckerImage(int width, int height) {
+    ImageData image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t* p = &image.pixels[(static_cast<size_t>(y) * width + x) * 4];
+            bool white = ((x + y) % 2) == 0;
+            p[0] = p[1] = p[2] = white ? 255 : 0;
+            p[3] = 128;
+        }
+    }
+    return image;
+}
+
+static bool testPremultiply() {
+    ImageData image = makeCheckerImage(2, 1);
+    image.premultiplyAlpha();
+    image.premultiplyAlpha(); // Second call must be a no-op
+    // White at half alpha is half intensity in linear light, 188 once encoded back to sRGB
+    bool ok = image.premultiplied && image.pixels[0] == 188 && image.pixels[3] == 128 && image.pixels[4] == 0;
+    return ok;
+}
+
+static bool testMipChain() {
+    // Odd sizes clamp: 5x3 -> 2x1 -> 1x1
+    std::vector<ImageData> levels = makeCheckerImage(5, 3).buildMipChain();
+    bool ok = levels.size() == 3 &&
+              levels[1].width == 2 && levels[1].height == 1 &&
+              levels[2].width == 1 && levels[2].height == 1 &&
+              levels[2].pixels.size() == 4;
+
+    // Averaging black and white in linear light gives 188, not the sRGB midpoint 128
+    ok = ok && makeCheckerImage(2, 2).halfSize().pixels[0] == 188;
+    return ok;
+}
+
+static bool testRoundTrip() {
+    std::string path = (std::filesystem::temp_directory_path() / "cooked_texture_test.crtex").string();
+    ImageData image = makeCheckerImage(16, 8);
+    image.premultiplyAlpha();
+    std::vector<ImageData> levels = image.buildMipChain();
+
+    bool ok = CookedTextureFile::write(path, levels, COOKED_TEXTURE_PREMULTIPLIED);
+    {
+        std::shared_ptr<CookedTextureFile> file = CookedTextureFile::open(path);
+        ok = ok && file && file->getMipCount() == levels.size() &&
+             (file->getHeader().flags & COOKED_TEXTURE_PREMULTIPLIED) != 0;
+        for (uint32_t i = 0; ok && i < file->getMipCount(); ++i) {
+            const CookedTextureLevel& level = file->getLevel(i);
+            ok = level.width == static_cast<uint32_t>(levels[i].width) &&
+                 level.height == static_cast<uint32_t>(levels[i].height) &&
+                 level.offset % COOKED_TEXTURE_ALIGNMENT == 0 &&
+                 std::memcmp(file->getLevelData(i), levels[i].pixels.data(), levels[i].pixels.size()) == 0;
+        }
+        ok = ok && file->findLevelForSize(0) == 0 && file->findLevelForSize(4) == 2 && file->findLevelForSize(1) == 4;
+    }
+
+    // Truncated files are rejected rather than read out of bounds
+    std::filesystem::resize_file(path, 64);
+    ok = ok && !CookedTextureFile::open(path);
+    std::remove(path.c_str());
+
+    return ok;
+}
+
+// Writes a valid container, applies corrupt to its bytes and checks that open() rejects the result
+template <typename Corrupt>
+static bool rejectsCorrupted(const std::string& path, Corrupt corrupt) {
+    std::vector<ImageData> levels = makeCheckerImage(16, 8).buildMipChain();
+    if (!CookedTextureFile::write(path, levels, COOKED_TEXTURE_PREMULTIPLIED)) {
+        return false;
+    }
+    std::vector<char> bytes(static_cast<size_t>(std::filesystem::file_size(path)));
+    std::ifstream(path, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    CookedTextureHeader* header = reinterpret_cast<CookedTextureHeader*>(bytes.data());
+    CookedTextureLevel* table = reinterpret_cast<CookedTextureLevel*>(bytes.data() + sizeof(CookedTextureHeader));
+    corrupt(*header, table);
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return !CookedTextureFile::open(path);
+}
+
+static bool testMalformedHeaders() {
+    std::string path = (std::filesystem::temp_directory_path() / "cooked_texture_malformed.crtex").string();
+    using Header = CookedTextureHeader;
+    using Level = CookedTextureLevel;
+
+    // The untouched file opens, so each rejection below is down to its own corruption
+    bool ok = !rejectsCorrupted(path, [](Header&, Level*) {});
+    // Level 0 is not the header's size
+    ok = rejectsCorrupted(path, [](Header& header, Level*) { header.width = 8; }) && ok;
+    // A level is not half the one above it (size kept consistent with its extent)
+    ok = rejectsCorrupted(path, [](Header&, Level* table) { table[1].height = 2; table[1].size = 8 * 2 * 4; }) && ok;
+    // Gaps, overlaps and out-of-order levels
+    ok = rejectsCorrupted(path, [](Header&, Level* table) { table[2].offset += COOKED_TEXTURE_ALIGNMENT; }) && ok;
+    ok = rejectsCorrupted(path, [](Header&, Level* table) { std::swap(table[0].offset, table[1].offset); }) && ok;
+    ok = rejectsCorrupted(path, [](Header&, Level* table) { table[0].offset = 0; }) && ok;
+    // offset + size wraps around, or runs past the end of the file
+    ok = rejectsCorrupted(path, [](Header&, Level* table) { table[4].offset = ~0ull - 2; }) && ok;
+    ok = rejectsCorrupted(path, [](Header&, Level* table) { table[4].size = ~0ull - 2; }) && ok;
+    // More levels than the chain down to 1x1 has, or a level 0 too large to be real
+    ok = rejectsCorrupted(path, [](Header& header, Level*) { header.mipCount = 6; }) && ok;
+    ok = rejectsCorrupted(path, [](Header& header, Level*) { header.width = 1u << 31; }) && ok;
+    std::remove(path.c_str());
+
+    return ok;
+}
+
+int main() {
+    return runTests("Cooked Texture", {
+        {"Premultiply", testPremultiply},
+        {"Mip chain", testMipChain},
+        {"Write/open round trip", testRoundTrip},
+        {"Malformed headers rejected", testMalformedHeaders}
+    });
+}
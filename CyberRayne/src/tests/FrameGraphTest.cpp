@@ -0,0 +1,140 @@
+#include <iostream>
+#include <string>
+#include "../../include/FrameGraph.h"
+#include "TestRunner.h"
+
+using Usage = FrameGraph::Usage;
+
+static bool hasBarrier(const std::vector<FrameGraph::Barrier>& barriers, int resource, Usage before, Usage after,
+                       uint32_t waitUsages, bool flushWrites) {
+    for (const FrameGraph::Barrier& barrier : barriers) {
+        if (barrier.resource == resource && barrier.before == before && barrier.after == after &&
+            barrier.waitUsages == waitUsages && barrier.flushWrites == flushWrites) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool testCulling() {
+    FrameGraph graph;
+    int backbuffer = graph.importImage("backbuffer", Usage::None, Usage::Present);
+    int scratch = graph.createTransient("scratch", 1024, 256);
+    int unused = graph.createTransient("unused", 1024, 256);
+
+    int overwritten = graph.addPass("overwritten", nullptr);  // Its output is cleared by "main"
+    graph.write(overwritten, backbuffer, Usage::ColorAttachment);
+    int producer = graph.addPass("producer", nullptr);
+    graph.write(producer, scratch, Usage::ColorAttachment);
+    int orphan = graph.addPass("orphan", nullptr);            // Nothing reads "unused"
+    graph.write(orphan, unused, Usage::ColorAttachment);
+    int main = graph.addPass("main", nullptr);
+    graph.read(main, scratch, Usage::Sampled);
+    graph.write(main, backbuffer, Usage::ColorAttachment);
+    int readback = graph.addPass("readback", nullptr);        // Reads only, kept for its side effect
+    graph.read(readback, backbuffer, Usage::TransferSrc);
+    graph.setSideEffect(readback);
+    graph.compile();
+
+    bool ok = graph.isCulled(overwritten) && !graph.isCulled(producer) && graph.isCulled(orphan) &&
+              !graph.isCulled(main) && !graph.isCulled(readback) && graph.getSchedule().size() == 3;
+    ok = ok && graph.getTransientOffset(unused) == UINT64_MAX && graph.getTransientHeapSize() == 1024;
+    return ok;
+}
+
+static bool testBarriers() {
+    // world -> upscale -> ui -> present, as the renderer declares it with a render scale
+    FrameGraph graph;
+    int backbuffer = graph.importImage("backbuffer", Usage::None, Usage::Present);
+    int scene = graph.createTransient("scene", 4096, 256);
+    int world = graph.addPass("world", nullptr);
+    graph.write(world, scene, Usage::ColorAttachment);
+    int upscale = graph.addPass("upscale", nullptr);
+    graph.read(upscale, scene, Usage::TransferSrc);
+    graph.write(upscale, backbuffer, Usage::TransferDst);
+    int ui = graph.addPass("ui", nullptr);
+    graph.modify(ui, backbuffer, Usage::ColorAttachment);
+    int probe = graph.addPass("probe", nullptr);               // Same layout as the upscale read
+    graph.read(probe, scene, Usage::TransferSrc);
+    graph.setSideEffect(probe);
+    graph.compile();
+
+    const auto& schedule = graph.getSchedule();
+    const uint32_t transferSrc = FrameGraph::usageBit(Usage::TransferSrc);
+    bool ok = schedule.size() == 4;
+    // The scene's discard waits for last frame's reads of it; nothing to flush
+    ok = ok && schedule[0].barriers.size() == 1 && hasBarrier(schedule[0].barriers, scene, Usage::None, Usage::ColorAttachment, transferSrc, false);
+    ok = ok && schedule[1].barriers.size() == 2 &&
+         hasBarrier(schedule[1].barriers, scene, Usage::ColorAttachment, Usage::TransferSrc, FrameGraph::usageBit(Usage::ColorAttachment), true) &&
+         hasBarrier(schedule[1].barriers, backbuffer, Usage::None, Usage::TransferDst, FrameGraph::usageBit(Usage::None), false);
+    ok = ok && schedule[2].barriers.size() == 1 &&
+         hasBarrier(schedule[2].barriers, backbuffer, Usage::TransferDst, Usage::ColorAttachment, FrameGraph::usageBit(Usage::TransferDst), true);
+    // A second read in the same layout needs no barrier
+    ok = ok && schedule[3].barriers.empty();
+    ok = ok && graph.getFinalBarriers().size() == 1 &&
+         hasBarrier(graph.getFinalBarriers(), backbuffer, Usage::ColorAttachment, Usage::Present, FrameGraph::usageBit(Usage::ColorAttachment), true);
+
+    // Reading after other reads in a new layout waits on all of them without flushing
+    graph.reset();
+    int image = graph.importImage("image", Usage::Sampled, Usage::None);
+    int a = graph.addPass("a", nullptr);
+    graph.read(a, image, Usage::Sampled);
+    graph.setSideEffect(a);
+    int b = graph.addPass("b", nullptr);
+    graph.read(b, image, Usage::TransferSrc);
+    graph.setSideEffect(b);
+    graph.compile();
+    ok = ok && graph.getSchedule()[0].barriers.empty() &&
+         hasBarrier(graph.getSchedule()[1].barriers, image, Usage::Sampled, Usage::TransferSrc, FrameGraph::usageBit(Usage::Sampled), false) &&
+         graph.getFinalBarriers().empty();
+    return ok;
+}
+
+static bool testAliasing() {
+    // A chain of passes, each reading the previous transient: first and third never live together
+    FrameGraph graph;
+    int backbuffer = graph.importImage("backbuffer", Usage::None, Usage::Present);
+    int first = graph.createTransient("first", 1000, 1);
+    int second = graph.createTransient("second", 500, 1);
+    int third = graph.createTransient("third", 1000, 256);
+    int a = graph.addPass("a", nullptr);
+    graph.write(a, first, Usage::ColorAttachment);
+    int b = graph.addPass("b", nullptr);
+    graph.read(b, first, Usage::Sampled);
+    graph.write(b, second, Usage::ColorAttachment);
+    int c = graph.addPass("c", nullptr);
+    graph.read(c, second, Usage::Sampled);
+    graph.write(c, third, Usage::ColorAttachment);
+    int d = graph.addPass("d", nullptr);
+    graph.read(d, third, Usage::Sampled);
+    graph.write(d, backbuffer, Usage::ColorAttachment);
+    graph.compile();
+
+    bool ok = graph.getTransientOffset(first) == 0 && graph.getTransientOffset(third) == 0 &&
+              graph.getTransientOffset(second) == 1000;
+    ok = ok && graph.getTransientHeapSize() == 1500 && graph.getTransientBytes() == 2500;
+    // "third" takes over the memory of "first", so its discard waits for the reads of both
+    ok = ok && hasBarrier(graph.getSchedule()[2].barriers, third, Usage::None, Usage::ColorAttachment,
+                          FrameGraph::usageBit(Usage::Sampled), false);
+
+    // Execution runs the live passes in order with their barriers first
+    std::string trace;
+    graph.reset();
+    int target = graph.importImage("target", Usage::None, Usage::TransferSrc);
+    int draw = graph.addPass("draw", [&trace] { trace += "draw;"; });
+    graph.write(draw, target, Usage::ColorAttachment);
+    int skipped = graph.addPass("skipped", [&trace] { trace += "skipped;"; });
+    graph.write(skipped, graph.createTransient("lost", 16, 1), Usage::TransferDst);
+    graph.compile();
+    graph.execute([&trace](const std::vector<FrameGraph::Barrier>& barriers) { trace += std::to_string(barriers.size()) + " barrier(s);"; });
+    ok = ok && trace == "1 barrier(s);draw;1 barrier(s);";
+    return ok;
+}
+
+int main() {
+    return runTests("Frame Graph", {
+        {"Culling", testCulling},
+        {"Barriers", testBarriers},
+        {"Aliasing", testAliasing}
+    });
+}
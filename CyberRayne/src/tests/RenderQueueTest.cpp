@@ -0,0 +1,47 @@
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include "../../include/RenderQueue.h"
+#include "TestRunner.h"
+
+static bool testMatchesStableSort() {
+    std::mt19937_64 rng(1234);
+    RenderQueue queue;
+    std::vector<RenderQueue::Entry> expected;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        // Few distinct values per field, so equal keys (and stability) are exercised
+        uint64_t key = RenderQueue::makeKey(static_cast<RenderLayer>(rng() % 4), static_cast<uint32_t>(rng() % 50),
+                                            0, static_cast<uint32_t>(rng() % 8));
+        queue.push(key);
+        expected.push_back({key, i});
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const RenderQueue::Entry& a, const RenderQueue::Entry& b) { return a.key < b.key; });
+    queue.sort();
+
+    bool ok = queue.size() == expected.size();
+    for (size_t i = 0; ok && i < expected.size(); ++i) {
+        ok = queue.getEntries()[i].key == expected[i].key && queue.getEntries()[i].index == expected[i].index;
+    }
+    return ok;
+}
+
+static bool testKeyOrdering() {
+    // Layer beats depth, depth beats texture; negative depths sort before positive ones
+    bool ok = RenderQueue::makeKey(RenderLayer::Tiles, 0xFFFFFFFFu, 0, 0xFFFFF) <
+              RenderQueue::makeKey(RenderLayer::Entities, 0, 0, 0);
+    ok = ok && RenderQueue::makeKey(RenderLayer::Entities, 1, 0, 0xFFFFF) < RenderQueue::makeKey(RenderLayer::Entities, 2, 0, 0);
+    ok = ok && RenderQueue::depthFromFloat(-2.0f) < RenderQueue::depthFromFloat(-1.0f) &&
+         RenderQueue::depthFromFloat(-1.0f) < RenderQueue::depthFromFloat(0.0f) &&
+         RenderQueue::depthFromFloat(0.0f) < RenderQueue::depthFromFloat(0.5f);
+    uint64_t key = RenderQueue::makeKey(RenderLayer::UI, 7, 0, 42);
+    ok = ok && RenderQueue::layerFromKey(key) == RenderLayer::UI && RenderQueue::textureFromKey(key) == 42;
+    return ok;
+}
+
+int main() {
+    return runTests("Render Queue", {
+        {"Radix sort matches stable sort", testMatchesStableSort},
+        {"Key ordering", testKeyOrdering}
+    });
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <cmath>
+#include "../../include/SdfFont.h"
+#include "TestRunner.h"
+
+// Alpha of the atlas texel under font-unit position (x, y) of the glyph at the start of `text`
+static float sampleGlyph(const SdfFont& font, const std::string& text, float x, float y) {
+    const SdfFont::GlyphQuad quad = font.layout(text).glyphs[0];
+    float u = quad.uvRect[0] + (x - quad.x) / quad.width * (quad.uvRect[2] - quad.uvRect[0]);
+    float v = quad.uvRect[1] + (y - quad.y) / quad.height * (quad.uvRect[3] - quad.uvRect[1]);
+    const ImageData& atlas = font.getAtlas();
+    int tx = static_cast<int>(u * atlas.width);
+    int ty = static_cast<int>(v * atlas.height);
+    return atlas.pixels[(static_cast<size_t>(ty) * atlas.width + tx) * 4 + 3] / 255.0f;
+}
+
+static bool testDistanceField() {
+    SdfFont font(8);
+    // '|' is the middle column (x 2..3) over all seven rows
+    float centre = sampleGlyph(font, "|", 2.5f, 3.5f);
+    float nearEdge = sampleGlyph(font, "|", 3.06f, 3.5f);
+    float far = sampleGlyph(font, "|", 0.5f, 3.5f);
+    bool ok = centre > 0.7f && std::fabs(nearEdge - 0.5f) < 0.1f && far == 0.0f;
+    ok = ok && font.getAtlas().width == 16 * 7 * 8 && font.getAtlas().height == 6 * 9 * 8;
+    return ok;
+}
+
+static bool testLayout() {
+    SdfFont font;
+    SdfFont::TextLayout layout = font.layout("HP 10\nab");
+    // Spaces emit nothing; the widest line is 5 advances minus the trailing spacing column
+    bool ok = layout.glyphs.size() == 6 && layout.width == 5 * SdfFont::ADVANCE - 1;
+    ok = ok && layout.height == 2 * SdfFont::GLYPH_ROWS + (SdfFont::LINE_HEIGHT - SdfFont::GLYPH_ROWS);
+    ok = ok && layout.glyphs[4].y == SdfFont::LINE_HEIGHT - SdfFont::CELL_PADDING && layout.glyphs[4].x == -SdfFont::CELL_PADDING;
+
+    // Non-printable characters fall back to '?'
+    SdfFont::TextLayout unknown = font.layout("\t");
+    SdfFont::TextLayout question = font.layout("?");
+    ok = ok && unknown.glyphs.size() == 1 && unknown.glyphs[0].uvRect[0] == question.glyphs[0].uvRect[0];
+    ok = ok && font.layout("").width == 0.0f;
+    return ok;
+}
+
+int main() {
+    return runTests("SDF Font", {
+        {"Distance field", testDistanceField},
+        {"Layout", testLayout}
+    });
+}
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "../../include/SpriteAnimation.h"
+#include "TestRunner.h"
+
+static bool near(float a, float b, float epsilon = 1e-5f) {
+    return std::fabs(a - b) <= epsilon;
+}
+
+static uint32_t bitsAt(const std::vector<float>& table, size_t word) {
+    uint32_t bits;
+    std::memcpy(&bits, &table[word], sizeof(bits));
+    return bits;
+}
+
+static bool testSelection() {
+    AnimationClip clip;
+    clip.frames = gridAnimationFrames(4, 1, 0, 4, 0.25f);
+    clip.loop = AnimationLoop::Loop;
+    bool ok = near(clip.duration(), 1.0f) && selectAnimationFrame(clip, 0.0f) == 0 &&
+              selectAnimationFrame(clip, 0.3f) == 1 && selectAnimationFrame(clip, 0.99f) == 3 &&
+              selectAnimationFrame(clip, 1.1f) == 0 && selectAnimationFrame(clip, -2.0f) == 0;
+
+    // Once holds the last frame; ping-pong walks back down after the end
+    clip.loop = AnimationLoop::Once;
+    ok = ok && selectAnimationFrame(clip, 5.0f) == 3;
+    clip.loop = AnimationLoop::PingPong;
+    ok = ok && selectAnimationFrame(clip, 1.1f) == 3 && selectAnimationFrame(clip, 1.3f) == 2 &&
+         selectAnimationFrame(clip, 1.9f) == 0 && selectAnimationFrame(clip, 2.1f) == 0;
+
+    // Uneven durations
+    clip.loop = AnimationLoop::Loop;
+    clip.frames[0].duration = 1.0f;
+    ok = ok && selectAnimationFrame(clip, 0.9f) == 0 && selectAnimationFrame(clip, 1.1f) == 1;
+
+    AnimationClip empty;
+    ok = ok && selectAnimationFrame(empty, 3.0f) == 0;
+    return ok;
+}
+
+static bool testGrid() {
+    // Second row of a 3x2 sheet, running off the end of the sheet stops at the last cell
+    std::vector<AnimationFrame> frames = gridAnimationFrames(3, 2, 3, 5, 0.1f);
+    bool ok = frames.size() == 3 && near(frames[0].uvRect[0], 0.0f) && near(frames[0].uvRect[1], 0.5f) &&
+              near(frames[2].uvRect[2], 1.0f) && near(frames[2].uvRect[3], 1.0f) && near(frames[1].duration, 0.1f);
+    ok = ok && gridAnimationFrames(0, 2, 0, 4, 0.1f).empty();
+    return ok;
+}
+
+static bool testTable() {
+    std::vector<AnimationClip> clips(3);
+    clips[0].frames = gridAnimationFrames(4, 2, 0, 4, 0.2f);
+    clips[0].loop = AnimationLoop::Loop;
+    clips[1].frames = gridAnimationFrames(4, 2, 4, 3, 0.15f);
+    clips[1].frames[1].duration = 0.4f;
+    clips[1].loop = AnimationLoop::PingPong;
+    clips[2].frames = gridAnimationFrames(4, 2, 7, 1, 0.5f);
+    clips[2].loop = AnimationLoop::Once;
+
+    std::vector<float> table;
+    packAnimationTable(clips, table);
+    bool ok = animationTableVec4Count(clips) == 3 + 8 * 2 && table.size() == (3 + 8 * 2) * 4;
+    ok = ok && bitsAt(table, 0) == 3 && bitsAt(table, 1) == 4 && bitsAt(table, 4) == 3 + 4 * 2 &&
+         bitsAt(table, 5) == 3 && bitsAt(table, 6) == static_cast<uint32_t>(AnimationLoop::PingPong);
+    // Second frame of clip 1: cell 5 of the sheet, ending at 0.15 + 0.4
+    const size_t frame = (3 + 4 * 2 + 2) * 4;
+    ok = ok && near(table[frame], 0.25f) && near(table[frame + 1], 0.5f) && near(table[frame + 4], 0.55f);
+
+    // Reading the packed table (the shader's reference model, not the GLSL itself) picks the same
+    // frames as the clips it was packed from, for every clip and loop mode
+    for (uint32_t c = 0; c < clips.size(); ++c) {
+        for (int step = -10; step < 400; ++step) {
+            const float time = static_cast<float>(step) * 0.0137f;
+            ok = ok && selectPackedAnimationFrame(table, c, time) == selectAnimationFrame(clips[c], time);
+        }
+    }
+    ok = ok && selectPackedAnimationFrame(table, 3, 0.5f) == 0;
+
+    // The UV remap moves frames into an atlas region
+    packAnimationTable(clips, table, [](const AnimationClip&, const float in[4], float out[4]) {
+        for (int i = 0; i < 4; ++i) {
+            out[i] = 0.5f + in[i] * 0.5f;
+        }
+    });
+    ok = ok && near(table[frame], 0.625f) && near(table[frame + 2], 0.75f) && near(table[frame + 4], 0.55f);
+    return ok;
+}
+
+int main() {
+    return runTests("Sprite Animation", {
+        {"Selection", testSelection},
+        {"Grid", testGrid},
+        {"Table", testTable}
+    });
+}
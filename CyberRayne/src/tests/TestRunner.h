@@ -0,0 +1,23 @@
+#pragma once
+
+#include <initializer_list>
+#include <iostream>
+
+// Runner shared by the self-checking tests. Each case returns whether it passed; the runner prints
+// a PASS/FAIL line per case and main returns its result, so a failing case fails the executable.
+struct TestCase {
+    const char* name;
+    bool (*run)();
+};
+
+inline int runTests(const char* suite, std::initializer_list<TestCase> cases) {
+    std::cout << suite << " Test" << std::endl;
+    bool allPassed = true;
+    for (const TestCase& test : cases) {
+        const bool passed = test.run();
+        std::cout << test.name << ": " << (passed ? "PASS" : "FAIL") << std::endl;
+        allPassed = allPassed && passed;
+    }
+    std::cout << "\n" << suite << " test " << (allPassed ? "completed successfully." : "FAILED.") << std::endl;
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include "../../include/TextureAtlas.h"
+#include "TestRunner.h"
+
+// Returns true if the padded rectangles of a and b overlap on the same page
+static bool overlaps(const TextureAtlas::Placement& a, const TextureAtlas::Placement& b, int padding) {
+    if (a.page != b.page) return false;
+    return a.x - padding < b.x + b.width + padding && b.x - padding < a.x + a.width + padding &&
+           a.y - padding < b.y + b.height + padding && b.y - padding < a.y + a.height + padding;
+}
+
+static bool checkPacking(TextureAtlas& atlas, const std::vector<TextureAtlas::PageSize>& sizes) {
+    std::vector<TextureAtlas::Placement> placements = atlas.pack(sizes);
+    const auto& pages = atlas.getPages();
+    const int padding = atlas.getPadding();
+    bool ok = true;
+
+    for (size_t i = 0; i < placements.size(); ++i) {
+        const auto& p = placements[i];
+        if (p.page < 0 || p.page >= static_cast<int>(pages.size())) {
+            std::cout << "  entry " << i << " was not placed" << std::endl;
+            ok = false;
+            continue;
+        }
+        if (p.width != sizes[i].width || p.height != sizes[i].height) {
+            std::cout << "  entry " << i << " has the wrong size" << std::endl;
+            ok = false;
+        }
+        if (p.x - padding < 0 || p.y - padding < 0 ||
+            p.x + p.width + padding > pages[p.page].width || p.y + p.height + padding > pages[p.page].height) {
+            std::cout << "  entry " << i << " is outside page " << p.page << std::endl;
+            ok = false;
+        }
+        for (size_t j = i + 1; j < placements.size(); ++j) {
+            if (overlaps(p, placements[j], padding)) {
+                std::cout << "  entries " << i << " and " << j << " overlap" << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    std::cout << "  " << sizes.size() << " entries on " << pages.size() << " page(s)";
+    for (const auto& page : pages) std::cout << " [" << page.width << "x" << page.height << "]";
+    std::cout << std::endl;
+    return ok;
+}
+
+// Nine equally sized tiles should share a single page
+static bool testTiles() {
+    TextureAtlas atlas(4096, 2);
+    std::vector<TextureAtlas::PageSize> tiles(9, {256, 256});
+    bool ok = checkPacking(atlas, tiles);
+    if (atlas.getPages().size() != 1) {
+        std::cout << "  expected one page for the tile set" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// Mixed UI sizes
+static bool testUI() {
+    TextureAtlas atlas(4096, 2);
+    std::vector<TextureAtlas::PageSize> ui = {
+        {1376, 768}, {1408, 736}, {1408, 736}, {1408, 768}, {1408, 736}, {1408, 736}, {64, 64}, {300, 20}
+    };
+    return checkPacking(atlas, ui);
+}
+
+// More content than one page holds must spill onto new pages
+static bool testOverflow() {
+    TextureAtlas atlas(512, 1);
+    std::vector<TextureAtlas::PageSize> many(40, {100, 100});
+    bool ok = checkPacking(atlas, many);
+    if (atlas.getPages().size() < 2) {
+        std::cout << "  expected the overflow set to use several pages" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// Entries bigger than a page are rejected rather than clipped
+static bool testOversized() {
+    TextureAtlas atlas(256, 2);
+    std::vector<TextureAtlas::Placement> placements = atlas.pack({{300, 10}});
+    return placements.size() == 1 && placements[0].page == -1;
+}
+
+int main() {
+    return runTests("Texture Atlas", {
+        {"Tiles", testTiles},
+        {"UI", testUI},
+        {"Overflow", testOverflow},
+        {"Oversized", testOversized}
+    });
+}
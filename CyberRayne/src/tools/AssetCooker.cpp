@@ -0,0 +1,136 @@
+// Offline asset cooker: decodes PNGs once at build time and writes GPU-ready .crtex containers
+// (RGBA8, optionally downscaled, premultiplied alpha, full mip chain) next to each source image.
+// The renderer maps these instead of decoding PNGs at startup and falls back to the PNG when missing.
+
+#include "../../include/CookedTexture.h"
+#include "../../include/ImageData.h"
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace fs = std::filesystem;
+
+struct CookerOptions {
+    int maxSize = 0;          // 0 = keep the source size
+    bool mips = true;
+    bool premultiply = true;
+    bool force = false;       // Re-cook even if the output is newer than the source
+};
+
+static void printUsage() {
+    std::cout << "Usage: asset_cooker <input file|dir> [output dir] [--max-size N] [--no-mips] [--no-premultiply] [--force]" << std::endl;
+    std::cout << "Without an output dir each .crtex is written next to its source image." << std::endl;
+}
+
+static bool isSourceImage(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".png";
+}
+
+static bool cookFile(const fs::path& source, const fs::path& output, const CookerOptions& options) {
+    std::error_code ec;
+    // Outputs from an older container version fail to open and are cooked again
+    if (!options.force && fs::exists(output, ec) && fs::last_write_time(output, ec) >= fs::last_write_time(source, ec) &&
+        CookedTextureFile::open(output.string())) {
+        return true;
+    }
+
+    ImageData image;
+    if (!ImageData::loadFromFile(source.string(), image)) {
+        return false;
+    }
+    if (options.maxSize > 0) {
+        image = image.downscaledToFit(options.maxSize);
+    }
+
+    uint32_t flags = 0;
+    if (options.premultiply) {
+        image.premultiplyAlpha();
+        flags |= COOKED_TEXTURE_PREMULTIPLIED;
+    }
+
+    std::vector<ImageData> levels;
+    if (options.mips) {
+        levels = image.buildMipChain();
+    } else {
+        levels.push_back(std::move(image));
+    }
+
+    fs::create_directories(output.parent_path(), ec);
+    if (!CookedTextureFile::write(output.string(), levels, flags)) {
+        std::cerr << "Failed to write: " << output.string() << std::endl;
+        return false;
+    }
+
+    std::cout << "Cooked " << source.string() << " -> " << output.string() << " (" << levels[0].width << "x"
+              << levels[0].height << ", " << levels.size() << " mips)" << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    CookerOptions options;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-size" && i + 1 < argc) {
+            options.maxSize = std::atoi(argv[++i]);
+        } else if (arg == "--no-mips") {
+            options.mips = false;
+        } else if (arg == "--no-premultiply") {
+            options.premultiply = false;
+        } else if (arg == "--force") {
+            options.force = true;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.empty() || positional.size() > 2) {
+        printUsage();
+        return 1;
+    }
+
+    fs::path input = positional[0];
+    fs::path outputDir = positional.size() > 1 ? fs::path(positional[1]) : fs::path();
+    if (!fs::exists(input)) {
+        std::cerr << "Input not found: " << input.string() << std::endl;
+        return 1;
+    }
+
+    // Collect sources; outputs mirror the input layout under outputDir when one is given
+    std::vector<std::pair<fs::path, fs::path>> jobs;
+    auto outputFor = [&](const fs::path& source, const fs::path& relative) {
+        fs::path cooked = outputDir.empty() ? source : outputDir / relative;
+        return fs::path(CookedTextureFile::cookedPathFor(cooked.string()));
+    };
+    if (fs::is_directory(input)) {
+        for (const auto& entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file() && isSourceImage(entry.path())) {
+                jobs.emplace_back(entry.path(), outputFor(entry.path(), fs::relative(entry.path(), input)));
+            }
+        }
+    } else {
+        jobs.emplace_back(input, outputFor(input, input.filename()));
+    }
+
+    int failures = 0;
+    for (const auto& job : jobs) {
+        if (!cookFile(job.first, job.second, options)) {
+            ++failures;
+        }
+    }
+
+    std::cout << "Cooked " << (jobs.size() - failures) << " of " << jobs.size() << " texture(s)." << std::endl;
+    return failures == 0 ? 0 : 1;
+}
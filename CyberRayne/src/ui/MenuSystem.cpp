@@ -5,7 +5,8 @@
 
 MenuSystem::MenuSystem() : m_selectedOption(MenuItem::START_GAME), m_optionSelected(false), m_highlightedIndex(0),
     m_backgroundTextureIndex(-1), m_nameBannerTextureIndex(-1), m_startButtonTextureIndex(-1), m_loadButtonTextureIndex(-1), m_settingsButtonTextureIndex(-1), 
-    m_quitButtonTextureIndex(-1), m_cursorTextureIndex(-1), m_highlightTextureIndex(-1) {
+    m_quitButtonTextureIndex(-1), m_cursorTextureIndex(-1), m_highlightTextureIndex(-1), m_cursorWidget(-1) {
+    for (int i = 0; i < 4; ++i) m_buttonWidgets[i] = -1;
     m_menuOptions = {
         "Start Game",
         "Load Game",
@@ -23,12 +24,32 @@ bool MenuSystem::initialize() {
     return true;
 }
 
+void MenuSystem::releaseTextures(VulkanRenderer* renderer) {
+    m_tree.clear();
+    int* handles[] = {
+        &m_backgroundTextureIndex, &m_nameBannerTextureIndex, &m_startButtonTextureIndex, &m_loadButtonTextureIndex,
+        &m_settingsButtonTextureIndex, &m_quitButtonTextureIndex, &m_cursorTextureIndex, &m_highlightTextureIndex
+    };
+    for (int* handle : handles) {
+        if (*handle >= 0) {
+            renderer->releaseTexture(*handle);
+            *handle = -1;
+        }
+    }
+}
+
 void MenuSystem::loadTextures(VulkanRenderer* renderer) {
     std::cout << "Loading menu textures..." << std::endl;
 
+    // Drop references from an earlier load before taking new ones
+    releaseTextures(renderer);
+
     const std::string base = renderer->getAssetsBasePath();
     auto exists = [](const std::string& p){ return std::filesystem::exists(p); };
 
+    // All menu images share atlas pages so the menu draws without texture rebinds
+    renderer->beginTextureAtlas();
+
     // Background
     const std::string bgPath = base + "/ui/menu_background.png";
     if (!exists(bgPath)) {
@@ -92,6 +113,8 @@ void MenuSystem::loadTextures(VulkanRenderer* renderer) {
     }
     m_cursorTextureIndex = renderer->loadTexture(cursorPath);
     std::cout << "Cursor texture index: " << m_cursorTextureIndex << std::endl;
+
+    renderer->endTextureAtlas();
     
     // For now, we'll use a simple colored rectangle for highlighting
     // In a real implementation, you might want to create a highlight texture
@@ -103,130 +126,53 @@ void MenuSystem::loadTextures(VulkanRenderer* renderer) {
     std::cout << "  Settings button: " << m_settingsButtonTextureIndex << std::endl;
     std::cout << "  Quit button: " << m_quitButtonTextureIndex << std::endl;
     std::cout << "  Highlight: " << m_highlightTextureIndex << std::endl;
-}
 
-void MenuSystem::update(float deltaTime) {
-    // No-op for now; input handled elsewhere
+    buildTree();
 }
 
-void MenuSystem::render(VulkanRenderer* renderer) {
-    renderMenuBackground(renderer);
-    renderMenuOptions(renderer);
-}
+void MenuSystem::buildTree() {
+    m_tree.clear();
 
-void MenuSystem::renderMenuBackground(VulkanRenderer* renderer) {
+    // Background covering the entire screen
     if (m_backgroundTextureIndex >= 0) {
-        int screenW = static_cast<int>(renderer->getSwapchainExtent().width);
-        int screenH = static_cast<int>(renderer->getSwapchainExtent().height);
-        // Render background covering the entire screen
-        renderer->renderSpritePixelsWithTexture(0, 0, screenW, screenH, m_backgroundTextureIndex);
+        m_tree.addImage(UIRect::fullScreen(), m_backgroundTextureIndex);
     }
-}
-
-void MenuSystem::renderMenuOptions(VulkanRenderer* renderer) {
-    std::cout << "Rendering menu options..." << std::endl;
-
-    const int screenW = static_cast<int>(renderer->getSwapchainExtent().width);
-    const int screenH = static_cast<int>(renderer->getSwapchainExtent().height);
-
-    std::cout << "Menu rendering - Screen size: " << screenW << "x" << screenH << std::endl;
 
     // ========== NAME BANNER (top-left) ==========
     if (m_nameBannerTextureIndex >= 0) {
-        const int bannerW = 450;  // Bigger banner
-        const int bannerH = 230;  // Bigger banner
-        const int bannerX = 50;   // Left margin
-        const int bannerY = 50;   // Top margin
-        renderer->renderSpritePixelsWithTexture(bannerX, bannerY, bannerW, bannerH, m_nameBannerTextureIndex);
+        m_tree.addImage(UIRect::pixels(0.0f, 0.0f, 50.0f, 50.0f, 450.0f, 230.0f), m_nameBannerTextureIndex);
     }
 
-    // ========== MAIN BUTTONS (bottom center: START, LOAD, QUIT in a row) ==========
-    const int buttonW = 200;
-    const int buttonH = 80;
-    const int gapX = 40;
-    
-    // Position buttons in bottom third of screen
-    const int rowY = screenH - 250;  // Distance from bottom
-    
-    // Center the three buttons horizontally
-    const int totalW = buttonW * 3 + gapX * 2;
-    const int leftX = (screenW - totalW) / 2;
-
-    // ========== SETTINGS BUTTON (below the main buttons, centered) ==========
-    const int settingsW = 200;
-    const int settingsH = 70;
-    const int settingsX = (screenW - settingsW) / 2;
-    const int settingsY = rowY + buttonH + 30;
+    // Cursor before the buttons so the fallback highlight sits behind the highlighted one
+    m_cursorWidget = m_tree.addCursor(m_cursorTextureIndex, 64.0f, 10.0f, -1);
 
-    std::cout << "Menu button positions:" << std::endl;
-    std::cout << "  Start: (" << leftX << ", " << rowY << ") size (" << buttonW << ", " << buttonH << ")" << std::endl;
-    std::cout << "  Load: (" << (leftX + buttonW + gapX) << ", " << rowY << ") size (" << buttonW << ", " << buttonH << ")" << std::endl;
-    std::cout << "  Quit: (" << (leftX + 2*(buttonW + gapX)) << ", " << rowY << ") size (" << buttonW << ", " << buttonH << ")" << std::endl;
-    std::cout << "  Settings: (" << settingsX << ", " << settingsY << ") size (" << settingsW << ", " << settingsH << ")" << std::endl;
-
-    // Helper to draw a highlight backdrop using NDC conversion
-    auto drawHighlight = [&](int x, int y, int w, int h) {
-        float ndcW = 2.0f * static_cast<float>(w) / static_cast<float>(screenW);
-        float ndcH = 2.0f * static_cast<float>(h) / static_cast<float>(screenH);
-        float cx = static_cast<float>(x) + w * 0.5f;
-        float cy = static_cast<float>(y) + h * 0.5f;
-        float ndcX = -1.0f + 2.0f * (cx / static_cast<float>(screenW));
-        float ndcY = -1.0f + 2.0f * (cy / static_cast<float>(screenH));
-        renderer->renderSprite(ndcX, ndcY, ndcW * 1.08f, ndcH * 1.15f); // slightly larger backdrop
-    };
-
-    // Helper to draw a placeholder panel (outer dark, inner light) using NDC conversion
-    auto drawPlaceholder = [&](int x, int y, int w, int h) {
-        float ndcW = 2.0f * static_cast<float>(w) / static_cast<float>(screenW);
-        float ndcH = 2.0f * static_cast<float>(h) / static_cast<float>(screenH);
-        float cx = static_cast<float>(x) + w * 0.5f;
-        float cy = static_cast<float>(y) + h * 0.5f;
-        float ndcX = -1.0f + 2.0f * (cx / static_cast<float>(screenW));
-        float ndcY = -1.0f + 2.0f * (cy / static_cast<float>(screenH));
-        // Outer (darker)
-        renderer->renderSprite(ndcX, ndcY, ndcW, ndcH);
-        // Inner (slightly smaller) to simulate border
-        renderer->renderSprite(ndcX, ndcY, ndcW * 0.9f, ndcH * 0.85f);
-    };
-
-    // Define positions for each item by index
-    struct Rect { int x,y,w,h,tex; } rects[4] = {
-        { leftX + 0*(buttonW+gapX), rowY, buttonW, buttonH, m_startButtonTextureIndex },
-        { leftX + 1*(buttonW+gapX), rowY, buttonW, buttonH, m_loadButtonTextureIndex },
-        { leftX + 2*(buttonW+gapX), rowY, buttonW, buttonH, m_quitButtonTextureIndex },
-        { settingsX, settingsY, settingsW, settingsH, m_settingsButtonTextureIndex }
-    };
-
-
-    // Helper to draw the cursor
-    auto drawCursor = [&](int targetX, int targetY, int targetH) {
-        if (m_cursorTextureIndex >= 0) {
-            int cursorSize = 64; // Adjust size as needed
-            // Position cursor to the left of the button, centered vertically relative to button height
-            int cursorX = targetX - cursorSize - 10; 
-            int cursorY = targetY + (targetH - cursorSize) / 2;
-            renderer->renderSpritePixelsWithTexture(cursorX, cursorY, cursorSize, cursorSize, m_cursorTextureIndex);
-        } else {
-            // Fallback to old highlight if cursor texture missing
-            drawHighlight(targetX, targetY, rects[m_highlightedIndex].w, rects[m_highlightedIndex].h);
-        }
+    // ========== MAIN BUTTONS (bottom center: START, LOAD, QUIT in a row) ==========
+    // 200x80 buttons 40px apart, centred, 250px from the bottom; settings 200x70 centred below them
+    const float buttonW = 200.0f;
+    const float buttonH = 80.0f;
+    const float gapX = 40.0f;
+    const float rowY = -250.0f;
+    const float leftX = -(buttonW * 3 + gapX * 2) * 0.5f;
+    struct Button { UIRect rect; int tex; } buttons[4] = {
+        { UIRect::pixels(0.5f, 1.0f, leftX + 0 * (buttonW + gapX), rowY, buttonW, buttonH), m_startButtonTextureIndex },
+        { UIRect::pixels(0.5f, 1.0f, leftX + 1 * (buttonW + gapX), rowY, buttonW, buttonH), m_loadButtonTextureIndex },
+        { UIRect::pixels(0.5f, 1.0f, leftX + 2 * (buttonW + gapX), rowY, buttonW, buttonH), m_quitButtonTextureIndex },
+        { UIRect::pixels(0.5f, 1.0f, -100.0f, rowY + buttonH + 30.0f, 200.0f, 70.0f), m_settingsButtonTextureIndex }
     };
-
     for (int i = 0; i < 4; ++i) {
-        if (i == m_highlightedIndex) {
-            // Draw cursor for the highlighted item
-            drawCursor(rects[i].x, rects[i].y, rects[i].h);
-        }
-        if (rects[i].tex >= 0) {
-            renderer->renderSpritePixelsWithTexture(rects[i].x, rects[i].y, rects[i].w, rects[i].h, rects[i].tex);
-        } else if (m_settingsButtonTextureIndex >= 0) {
-            // Use settings icon as a visual placeholder to avoid defaulting to texture 0
-            renderer->renderSpritePixelsWithTexture(rects[i].x, rects[i].y, rects[i].w, rects[i].h, m_settingsButtonTextureIndex);
-        } else {
-            // Last resort: just draw the highlight frame (no extra panel)
-            drawHighlight(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
-        }
+        // Use settings icon as a visual placeholder to avoid defaulting to texture 0
+        int tex = buttons[i].tex >= 0 ? buttons[i].tex : m_settingsButtonTextureIndex;
+        m_buttonWidgets[i] = m_tree.addImage(buttons[i].rect, tex);
     }
+    m_tree.setCursorTarget(m_cursorWidget, m_buttonWidgets[m_highlightedIndex]);
+}
+
+void MenuSystem::update(float deltaTime) {
+    // No-op for now; input handled elsewhere
+}
+
+void MenuSystem::render(VulkanRenderer* renderer) {
+    m_tree.render(renderer);
 }
 
 void MenuSystem::handleInput(int key) {
@@ -266,4 +212,5 @@ void MenuSystem::handleInput(int key) {
             else if (m_highlightedIndex == 1) m_highlightedIndex = 2;
             break;
     }
+    m_tree.setCursorTarget(m_cursorWidget, m_buttonWidgets[m_highlightedIndex]);
 }
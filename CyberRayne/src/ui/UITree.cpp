@@ -0,0 +1,220 @@
+#include "../../include/UITree.h"
+#include "../../include/TextRenderer.h"
+#include <algorithm>
+#include <cstring>
+
+int UITree::addWidget(const Widget& widget) {
+    m_widgets.push_back(widget);
+    m_dirty = true;
+    return static_cast<int>(m_widgets.size() - 1);
+}
+
+int UITree::addImage(const UIRect& rect, int texture) {
+    Widget widget;
+    widget.type = WidgetType::Image;
+    widget.rect = rect;
+    widget.texture = texture;
+    return addWidget(widget);
+}
+
+int UITree::addButton(const UIRect& rect, int texture, const std::string& label, float labelHeight) {
+    Widget widget;
+    widget.type = WidgetType::Button;
+    widget.rect = rect;
+    widget.texture = texture;
+    widget.text = label;
+    widget.textHeight = labelHeight;
+    return addWidget(widget);
+}
+
+int UITree::addBar(const UIRect& rect, const float fillColor[4], const float backColor[4]) {
+    Widget widget;
+    widget.type = WidgetType::Bar;
+    widget.rect = rect;
+    std::copy(fillColor, fillColor + 4, widget.color);
+    std::copy(backColor, backColor + 4, widget.backColor);
+    return addWidget(widget);
+}
+
+int UITree::addText(const UIRect& rect, const std::string& text, float height, const float color[4], float align) {
+    Widget widget;
+    widget.type = WidgetType::Text;
+    widget.rect = rect;
+    widget.text = text;
+    widget.textHeight = height;
+    widget.align = align;
+    std::copy(color, color + 4, widget.color);
+    return addWidget(widget);
+}
+
+int UITree::addCursor(int texture, float size, float gap, int target) {
+    Widget widget;
+    widget.type = WidgetType::Cursor;
+    widget.texture = texture;
+    widget.rect.size[0] = widget.rect.size[1] = size;
+    widget.rect.offset[0] = gap;
+    widget.target = target;
+    return addWidget(widget);
+}
+
+void UITree::clear() {
+    m_widgets.clear();
+    m_baked.clear();
+    m_resolved.clear();
+    m_dirty = true;
+}
+
+void UITree::setVisible(int widget, bool visible) {
+    if (isValid(widget) && m_widgets[widget].visible != visible) {
+        m_widgets[widget].visible = visible;
+        m_dirty = true;
+    }
+}
+
+void UITree::setTexture(int widget, int texture) {
+    if (isValid(widget) && m_widgets[widget].texture != texture) {
+        m_widgets[widget].texture = texture;
+        m_dirty = true;
+    }
+}
+
+void UITree::setText(int widget, const std::string& text) {
+    if (isValid(widget) && m_widgets[widget].text != text) {
+        m_widgets[widget].text = text;
+        m_dirty = true;
+    }
+}
+
+void UITree::setColor(int widget, const float color[4]) {
+    if (isValid(widget) && !std::equal(color, color + 4, m_widgets[widget].color)) {
+        std::copy(color, color + 4, m_widgets[widget].color);
+        m_dirty = true;
+    }
+}
+
+void UITree::setValue(int widget, float value) {
+    value = std::clamp(value, 0.0f, 1.0f);
+    if (isValid(widget) && m_widgets[widget].value != value) {
+        m_widgets[widget].value = value;
+        m_dirty = true;
+    }
+}
+
+void UITree::setCursorTarget(int cursor, int target) {
+    if (isValid(cursor) && m_widgets[cursor].target != target) {
+        m_widgets[cursor].target = target;
+        m_dirty = true;
+    }
+}
+
+void UITree::layout(float screenWidth, float screenHeight) {
+    for (Widget& widget : m_widgets) {
+        const UIRect& rect = widget.rect;
+        widget.width = rect.size[0] + rect.relativeSize[0] * screenWidth;
+        widget.height = rect.size[1] + rect.relativeSize[1] * screenHeight;
+        widget.left = rect.anchor[0] * screenWidth + rect.offset[0];
+        widget.top = rect.anchor[1] * screenHeight + rect.offset[1];
+        if (widget.type == WidgetType::Text && m_textRenderer) {
+            m_textRenderer->measureText(widget.text, widget.textHeight, widget.width, widget.height);
+            widget.left -= widget.align * widget.width;
+        }
+    }
+
+    // Cursors follow their target, so they go after everything else is placed
+    for (Widget& widget : m_widgets) {
+        if (widget.type != WidgetType::Cursor || !isValid(widget.target)) {
+            continue;
+        }
+        const Widget& target = m_widgets[widget.target];
+        widget.left = target.left - widget.width - widget.rect.offset[0];
+        widget.top = target.top + (target.height - widget.height) * 0.5f;
+    }
+}
+
+void UITree::bakeQuad(float left, float top, float width, float height, int texture, const float tint[4],
+                      float screenWidth, float screenHeight) {
+    SpriteInstance instance = SpriteInstance::make(-1.0f + 2.0f * (left + width * 0.5f) / screenWidth,
+                                                   -1.0f + 2.0f * (top + height * 0.5f) / screenHeight,
+                                                   2.0f * width / screenWidth, 2.0f * height / screenHeight, texture);
+    std::copy(tint, tint + 4, instance.tint);
+    m_baked.push_back(instance);
+}
+
+void UITree::bake(float screenWidth, float screenHeight) {
+    static const float WHITE[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const float HIGHLIGHT[4] = {1.0f, 1.0f, 1.0f, 0.35f};
+    m_baked.clear();
+    for (const Widget& widget : m_widgets) {
+        if (!widget.visible) {
+            continue;
+        }
+        switch (widget.type) {
+        case WidgetType::Image:
+        case WidgetType::Button:
+            if (widget.texture >= 0) {
+                bakeQuad(widget.left, widget.top, widget.width, widget.height, widget.texture, WHITE, screenWidth, screenHeight);
+            }
+            if (widget.type == WidgetType::Button && m_textRenderer && !widget.text.empty()) {
+                float labelW, labelH;
+                m_textRenderer->measureText(widget.text, widget.textHeight, labelW, labelH);
+                m_textRenderer->appendText(m_baked, widget.text, widget.left + (widget.width - labelW) * 0.5f,
+                                           widget.top + (widget.height - labelH) * 0.5f, widget.textHeight, widget.color,
+                                           screenWidth, screenHeight);
+            }
+            break;
+        case WidgetType::Bar:
+            bakeQuad(widget.left, widget.top, widget.width, widget.height, 0, widget.backColor, screenWidth, screenHeight);
+            if (widget.value > 0.0f) {
+                bakeQuad(widget.left, widget.top, widget.width * widget.value, widget.height, 0, widget.color, screenWidth, screenHeight);
+            }
+            break;
+        case WidgetType::Text:
+            if (m_textRenderer) {
+                m_textRenderer->appendText(m_baked, widget.text, widget.left, widget.top, widget.textHeight, widget.color,
+                                           screenWidth, screenHeight);
+            }
+            break;
+        case WidgetType::Cursor:
+            if (!isValid(widget.target) || !m_widgets[widget.target].visible) {
+                break;
+            }
+            if (widget.texture >= 0) {
+                bakeQuad(widget.left, widget.top, widget.width, widget.height, widget.texture, WHITE, screenWidth, screenHeight);
+            } else {
+                // No cursor image: a translucent backdrop slightly larger than the target
+                const Widget& target = m_widgets[widget.target];
+                bakeQuad(target.left - target.width * 0.04f, target.top - target.height * 0.075f,
+                         target.width * 1.08f, target.height * 1.15f, 0, HIGHLIGHT, screenWidth, screenHeight);
+            }
+            break;
+        }
+    }
+    ++m_bakeCount;
+}
+
+void UITree::resolve(VulkanRenderer* renderer) {
+    m_resolved.resize(m_baked.size());
+    for (size_t i = 0; i < m_baked.size(); ++i) {
+        m_resolved[i] = renderer->resolveSpriteInstance(m_baked[i]);
+    }
+    m_resolvedRevision = renderer->getTextureRegionRevision();
+}
+
+void UITree::render(VulkanRenderer* renderer) {
+    const VkExtent2D extent = renderer->getSwapchainExtent();
+    if (extent.width == 0 || extent.height == 0) {
+        return;
+    }
+
+    if (m_dirty || extent.width != m_extent.width || extent.height != m_extent.height) {
+        m_extent = extent;
+        layout(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        bake(static_cast<float>(extent.width), static_cast<float>(extent.height));
+        resolve(renderer);
+        m_dirty = false;
+    } else if (m_resolvedRevision != renderer->getTextureRegionRevision()) {
+        // A texture finished loading or moved: same sprites, new slots
+        resolve(renderer);
+    }
+    renderer->renderResolvedSprites(m_resolved);
+}